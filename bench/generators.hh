@@ -0,0 +1,240 @@
+// "generators.hh" -- implements seeded synthetic graph generators for the benchmarks of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Every generator returns a symmetric Graph with ascending row indices and no
+// diagonal, and depends on nothing but its arguments: the same seed gives the
+// same graph on every machine, as std::mt19937_64 is fully specified and only
+// its raw output is used.
+
+#ifndef GENERATORS_HH
+#define GENERATORS_HH
+
+#include "Graph.hh"
+#include <random>
+#include <tuple>
+
+namespace lat {
+
+// Uniform real in [0, 1) from the raw engine output, identical on every platform.
+inline double unit_real(std::mt19937_64 & engine) {
+    return (engine() >> 11) * 0x1.0p-53;
+}
+
+// Symmetric CSC graph from undirected edges (u, v, weight), u != v. Repeated
+// edges are merged by adding their weights.
+template<typename R, typename Z>
+const Graph<R, Z> from_edges(const Z n, std::vector<std::tuple<Z, Z, R>> edges) {
+    const std::size_t m = edges.size();
+
+    for (std::size_t e = 0; e < m; e++) {
+        const auto [u, v, w] = edges[e];
+
+        edges.emplace_back(v, u, w);
+    }
+
+    std::sort(edges.begin(), edges.end(), [] (const std::tuple<Z, Z, R> & a, const std::tuple<Z, Z, R> & b) {
+                                              return std::tie(std::get<1>(a), std::get<0>(a)) < std::tie(std::get<1>(b), std::get<0>(b));
+                                          });
+
+    std::vector<R> A;
+
+    std::vector<Z> IA, JA(n + 1, 0);
+
+    for (const auto & [i, j, w] : edges) {
+        if (!IA.empty() && JA[j + 1] > 0 && IA.back() == i) {
+            A.back() += w;
+        }
+        else {
+            A.push_back(w); IA.push_back(i); JA[j + 1]++;
+        }
+    }
+
+    std::partial_sum(JA.begin(), JA.end(), JA.begin());
+
+    return Graph<R, Z>(std::move(A), std::move(IA), std::move(JA), n, n);
+}
+
+// side x side 4-point grid, unit weights.
+template<typename R, typename Z>
+const Graph<R, Z> grid_2d(const Z side) {
+    std::vector<std::tuple<Z, Z, R>> edges;
+
+    for (Z y = 0; y < side; y++) {
+        for (Z x = 0; x < side; x++) {
+            const Z v = y * side + x;
+
+            if (x + 1 < side) {
+                edges.emplace_back(v, v + 1, 1.);
+            }
+
+            if (y + 1 < side) {
+                edges.emplace_back(v, v + side, 1.);
+            }
+        }
+    }
+
+    return from_edges<R, Z>(side * side, std::move(edges));
+}
+
+// side x side x side 6-point grid, unit weights.
+template<typename R, typename Z>
+const Graph<R, Z> grid_3d(const Z side) {
+    std::vector<std::tuple<Z, Z, R>> edges;
+
+    for (Z z = 0; z < side; z++) {
+        for (Z y = 0; y < side; y++) {
+            for (Z x = 0; x < side; x++) {
+                const Z v = (z * side + y) * side + x;
+
+                if (x + 1 < side) {
+                    edges.emplace_back(v, v + 1, 1.);
+                }
+
+                if (y + 1 < side) {
+                    edges.emplace_back(v, v + side, 1.);
+                }
+
+                if (z + 1 < side) {
+                    edges.emplace_back(v, v + side * side, 1.);
+                }
+            }
+        }
+    }
+
+    return from_edges<R, Z>(side * side * side, std::move(edges));
+}
+
+// n points uniform in the unit square, joined when closer than radius; the
+// expected degree is about n * pi * radius^2. Unit weights.
+template<typename R, typename Z>
+const Graph<R, Z> random_geometric(const Z n, const double radius, const unsigned long long seed) {
+    std::mt19937_64 engine(seed);
+
+    std::vector<double> x(n), y(n);
+
+    for (Z v = 0; v < n; v++) {
+        x[v] = unit_real(engine); y[v] = unit_real(engine);
+    }
+
+    const Z cells = std::max<Z>(1, std::min<Z>(static_cast<Z>(1 / radius), 4096));
+
+    const auto cell = [cells] (const double t) { return std::min<Z>(cells - 1, static_cast<Z>(t * cells)); };
+
+    std::vector<std::vector<Z>> bucket(static_cast<std::size_t>(cells) * cells);
+
+    for (Z v = 0; v < n; v++) {
+        bucket[cell(y[v]) * cells + cell(x[v])].push_back(v);
+    }
+
+    std::vector<std::tuple<Z, Z, R>> edges;
+
+    for (Z v = 0; v < n; v++) {
+        const Z cx = cell(x[v]), cy = cell(y[v]);
+
+        for (Z by = std::max<Z>(0, cy - 1); by <= std::min<Z>(cells - 1, cy + 1); by++) {
+            for (Z bx = std::max<Z>(0, cx - 1); bx <= std::min<Z>(cells - 1, cx + 1); bx++) {
+                for (const Z u : bucket[by * cells + bx]) {
+                    const double dx = x[u] - x[v], dy = y[u] - y[v];
+
+                    if (u > v && dx * dx + dy * dy < radius * radius) {
+                        edges.emplace_back(v, u, 1.);
+                    }
+                }
+            }
+        }
+    }
+
+    return from_edges<R, Z>(n, std::move(edges));
+}
+
+// Barabasi-Albert preferential attachment: every new node joins m distinct
+// existing nodes chosen with probability proportional to their degree, which
+// gives a power-law degree distribution. Unit weights.
+template<typename R, typename Z>
+const Graph<R, Z> power_law(const Z n, const Z m, const unsigned long long seed) {
+    std::mt19937_64 engine(seed);
+
+    std::vector<std::tuple<Z, Z, R>> edges;
+
+    std::vector<Z> ends, chosen;
+
+    for (Z v = 1; v < std::min(n, m + 1); v++) {
+        for (Z u = 0; u < v; u++) {
+            edges.emplace_back(u, v, 1.); ends.push_back(u); ends.push_back(v);
+        }
+    }
+
+    for (Z v = m + 1; v < n; v++) {
+        chosen.clear();
+
+        while (static_cast<Z>(chosen.size()) < m) {
+            const Z u = ends[engine() % ends.size()];
+
+            if (std::find(chosen.begin(), chosen.end(), u) == chosen.end()) {
+                chosen.push_back(u);
+            }
+        }
+
+        for (const Z u : chosen) {
+            edges.emplace_back(u, v, 1.); ends.push_back(u); ends.push_back(v);
+        }
+    }
+
+    return from_edges<R, Z>(n, std::move(edges));
+}
+
+// Banded matrix pattern: every pair at most bandwidth apart is an edge with
+// probability density, weighted uniformly in [1, 10).
+template<typename R, typename Z>
+const Graph<R, Z> banded(const Z n, const Z bandwidth, const double density, const unsigned long long seed) {
+    std::mt19937_64 engine(seed);
+
+    std::vector<std::tuple<Z, Z, R>> edges;
+
+    for (Z v = 0; v < n; v++) {
+        for (Z u = v + 1; u < std::min(n, v + bandwidth + 1); u++) {
+            if (unit_real(engine) < density) {
+                edges.emplace_back(v, u, 1 + 9 * unit_real(engine));
+            }
+        }
+    }
+
+    return from_edges<R, Z>(n, std::move(edges));
+}
+
+// Seeded random order of the n nodes, Fisher-Yates on the raw engine output.
+template<typename Z>
+const std::vector<Z> shuffled_sequence(const Z n, const unsigned long long seed) {
+    std::mt19937_64 engine(seed);
+
+    std::vector<Z> sequence(n);
+
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    for (Z i = n - 1; i > 0; i--) {
+        std::swap(sequence[i], sequence[engine() % (i + 1)]);
+    }
+
+    return sequence;
+}
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+// "parallel_select_best_swap.cc" -- thread scaling benchmark of parallel_select_best_swap for the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Build : cmake --build build --target parallel_select_best_swap (see CMakeLists.txt), or
+//         g++ -std=c++17 -O3 -fopenmp -I../include parallel_select_best_swap.cc
+// Usage : ./a.out [side = 64]
+//
+// Scans the 2-swap neighbourhood of a shuffled side x side grid with 1, 2, 4,
+// ... up to omp_get_max_threads() threads and prints, per thread count, the
+// time per scan, the speedup over one thread and the move selected, which
+// must be the same on every line.
+
+#include "generators.hh"
+#include "parallel_full_search.hh"
+#include <string>
+
+int main(int argc, char * argv[]) {
+    const int side = argc > 1 ? std::stoi(argv[1]) : 64;
+
+    const lat::Graph<double, int> G = lat::grid_2d<double, int>(side);
+
+    const lat::Graph<double, int> S = lat::symmetrize(G);
+
+    const std::vector<int> sequence = lat::shuffled_sequence(lat::numnodes(G), 2019ULL);
+
+    const int max_threads = omp_get_max_threads();
+
+    double t1 = .0;
+
+    std::cout << "threads\tseconds\tspeedup\tdelta\ti\tj\n";
+
+    for (int m = 1; ; m = std::min(2 * m, max_threads)) {
+        omp_set_num_threads(m);
+
+        lat::Arrangement<double, int> P(G, sequence);
+
+        const double start = omp_get_wtime();
+
+        const double delta = lat::parallel_select_best_swap(S, P);
+
+        const double t = omp_get_wtime() - start;
+
+        if (m == 1) {
+            t1 = t;
+        }
+
+        int i = 0;
+
+        while (i < lat::numnodes(G) && P[i] == sequence[i]) {
+            i++;
+        }
+
+        const int j = i < lat::numnodes(G) ? P.position(sequence[i]) : i;
+
+        std::cout << m << '\t' << t << '\t' << t1 / t << '\t' << delta << '\t' << i << '\t' << j << '\n';
+
+        if (m == max_threads) {
+            break;
+        }
+    }
+
+    return 0;
+}
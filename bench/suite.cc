@@ -0,0 +1,305 @@
+// "suite.cc" -- reproducible benchmark suite of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Build : cmake --build build --target suite (see CMakeLists.txt), or
+//         g++ -std=c++17 -O3 -fopenmp -I../include suite.cc -o suite
+// Usage : ./suite [scale = 1] > results.jsonl
+//
+// Times la, parallel_la, permute (the kernel of G(p) and Graph::perm), one
+// scan of the 2-swap neighbourhood by select_best_swap and
+// parallel_select_best_swap (the step of full_search and parallel_full_search)
+// and successive_augmentation on seeded 2D/3D grids, random geometric,
+// power-law and banded graphs of about 1024, 4096 and 16384 nodes times
+// scale, and multilevel_sequence on the power-law graphs, whose hubs stall
+// plain heavy-edge matching. Parallel kernels run with 1, 2, 4, ... up to
+// omp_get_max_threads() threads. Every measurement is one JSON object per line
+// on stdout with the best wall time per repetition, evaluations per second
+// (entries for la and permute, swaps for the scans, nodes for
+// successive_augmentation and multilevel_sequence), the bytes allocated per
+// repetition, the speedup over one thread, and a checksum of the result that
+// must not change between commits unless the results do. Diff two runs with
+// e.g. jq or a spreadsheet; everything but the timings is deterministic.
+//
+// On the power-law graphs portfolio also races each of its default
+// strategies run alone (as a portfolio of that one strategy) with all threads
+// and the same time budget, from the same shuffled sequence. Each racer is
+// one "portfolio_race" line with its final cost and the seconds it took to
+// get within 1% of the best cost any racer found (- 1 if it never did);
+// these depend on timing.
+
+#include "generators.hh"
+#include "full_search.hh"
+#include "multilevel.hh"
+#include "parallel_full_search.hh"
+#include "portfolio.hh"
+#include "successive_augmentation.hh"
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+
+static std::atomic<unsigned long long> allocated_bytes{0};
+
+void * operator new(std::size_t size) {
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void * ptr = std::malloc(size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void * ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using Z = int;
+
+using R = double;
+
+struct Measurement final {
+    double seconds;
+
+    unsigned long long bytes, reps;
+
+    double checksum;
+};
+
+// Runs kernel once to warm up and then until 5 repetitions or half a second
+// have passed; reports the fastest repetition and the mean bytes allocated.
+Measurement measure(const std::function<double ()> & kernel) {
+    Measurement m{1e300, 0, 0, kernel()};
+
+    const unsigned long long bytes = allocated_bytes.load();
+
+    const double start = omp_get_wtime();
+
+    while (m.reps < 5 && (m.reps == 0 || omp_get_wtime() - start < .5)) {
+        const double t = omp_get_wtime();
+
+        m.checksum = kernel();
+
+        m.seconds = std::min(m.seconds, omp_get_wtime() - t);
+
+        m.reps++;
+    }
+
+    m.bytes = (allocated_bytes.load() - bytes) / m.reps;
+
+    return m;
+}
+
+void report(const std::string & benchmark, const std::string & graph, const lat::Graph<R, Z> & G, const int threads,
+            const Measurement & m, const double evaluations, const double speedup) {
+    std::printf("{\"benchmark\":\"%s\",\"graph\":\"%s\",\"n\":%d,\"nnz\":%d,\"threads\":%d,\"reps\":%llu,"
+                "\"seconds\":%.6e,\"evaluations_per_second\":%.6e,\"bytes_allocated\":%llu,\"speedup\":%.3f,\"checksum\":%.17g}\n",
+                benchmark.c_str(), graph.c_str(), lat::numnodes(G), lat::nnz(G), threads, m.reps,
+                m.seconds, evaluations / m.seconds, m.bytes, speedup, m.checksum);
+
+    std::fflush(stdout);
+}
+
+// Measures kernel with 1, 2, 4, ... threads, or with 1 thread only if it is serial.
+void scale_threads(const std::string & benchmark, const std::string & graph, const lat::Graph<R, Z> & G,
+                   const double evaluations, const bool parallel, const std::function<double ()> & kernel) {
+    const int max_threads = omp_get_max_threads();
+
+    double t1 = .0;
+
+    for (int m = 1; ; m = std::min(2 * m, max_threads)) {
+        omp_set_num_threads(m);
+
+        const Measurement result = measure(kernel);
+
+        if (m == 1) {
+            t1 = result.seconds;
+        }
+
+        report(benchmark, graph, G, m, result, evaluations, t1 / result.seconds);
+
+        if (!parallel || m == max_threads) {
+            break;
+        }
+    }
+
+    omp_set_num_threads(max_threads);
+}
+
+void run(const std::string & graph, const lat::Graph<R, Z> & G) {
+    const Z n = lat::numnodes(G);
+
+    const double entries = lat::nnz(G);
+
+    const std::vector<Z> sequence = lat::shuffled_sequence(n, 2019);
+
+    const lat::Graph<R, Z> H = G(sequence);
+
+    scale_threads("la", graph, G, entries, false, [&] { return lat::la(H); });
+
+    scale_threads("parallel_la", graph, G, entries, true, [&] { return lat::parallel_la(H); });
+
+    lat::Workspace<R, Z> W;
+
+    scale_threads("permute", graph, G, entries, true, [&] {
+                                                          lat::permute(G, sequence, W);
+
+                                                          return static_cast<double>(W.IA[W.IA.size() / 2]);
+                                                      });
+
+    const lat::Graph<R, Z> S = lat::symmetrize(G);
+
+    const double swaps = 0.5 * n * (n - 1.);
+
+    if (n <= 8192) {
+        scale_threads("select_best_swap", graph, G, swaps, false, [&] {
+                                                                      lat::Arrangement<R, Z> P(G, sequence);
+
+                                                                      return lat::select_best_swap(S, P);
+                                                                  });
+
+        scale_threads("parallel_select_best_swap", graph, G, swaps, true, [&] {
+                                                                               lat::Arrangement<R, Z> P(G, sequence);
+
+                                                                               return lat::parallel_select_best_swap(S, P);
+                                                                           });
+    }
+
+    if (n <= 32768) {
+        scale_threads("successive_augmentation", graph, G, n, false, [&] {
+                                                                         return lat::la(G(lat::successive_augmentation(G, sequence)));
+                                                                     });
+    }
+}
+
+// Runs portfolio over strategies for seconds and returns the time and cost of
+// every improvement found, starting with the cost of sequence at time 0.
+std::vector<std::pair<double, R>> trace_portfolio(const lat::Graph<R, Z> & G, const std::vector<Z> & sequence,
+                                                  const std::vector<lat::Strategy<R, Z>> & strategies, const double seconds) {
+    lat::Stopwatch clock;
+
+    std::mutex lock;
+
+    std::vector<std::pair<double, R>> trace{{.0, lat::la(G(sequence))}};
+
+    std::vector<lat::Strategy<R, Z>> traced;
+
+    for (const lat::Strategy<R, Z> & strategy : strategies) {
+        traced.push_back([&, strategy] (const lat::Graph<R, Z> & H, const std::vector<Z> & start, unsigned long long seed,
+                                        const lat::Budget & budget) {
+                             std::vector<Z> result = strategy(H, start, seed, budget);
+
+                             const R cost = lat::la(lat::Arrangement<R, Z>(H, result));
+
+                             std::lock_guard<std::mutex> guard(lock);
+
+                             if (cost < trace.back().second) {
+                                 trace.emplace_back(clock.elapsed(), cost);
+                             }
+
+                             return result;
+                         });
+    }
+
+    lat::Budget budget;
+
+    budget.seconds = seconds;
+
+    lat::portfolio(G, sequence, traced, budget, std::numeric_limits<Z>::max());
+
+    return trace;
+}
+
+void race(const std::string & graph, const lat::Graph<R, Z> & G, const double seconds) {
+    const std::vector<Z> sequence = lat::shuffled_sequence(lat::numnodes(G), 2019);
+
+    const std::vector<lat::Strategy<R, Z>> strategies = lat::default_strategies<R, Z>();
+
+    const std::vector<std::string> names{"portfolio", "tabu_or_opt", "annealing", "window_dp", "successive_augmentation"};
+
+    std::vector<std::vector<std::pair<double, R>>> traces;
+
+    traces.push_back(trace_portfolio(G, sequence, strategies, seconds));
+
+    for (const lat::Strategy<R, Z> & strategy : strategies) {
+        traces.push_back(trace_portfolio(G, sequence, {strategy}, seconds));
+    }
+
+    R best = traces[0].back().second;
+
+    for (const auto & trace : traces) {
+        best = std::min(best, trace.back().second);
+    }
+
+    const R target = best + .01 * std::abs(best);
+
+    for (std::size_t r = 0; r < traces.size(); r++) {
+        double to_target = - 1;
+
+        for (const auto & point : traces[r]) {
+            if (point.second <= target) {
+                to_target = point.first;
+
+                break;
+            }
+        }
+
+        std::printf("{\"benchmark\":\"portfolio_race\",\"graph\":\"%s\",\"n\":%d,\"nnz\":%d,\"threads\":%d,\"racer\":\"%s\","
+                    "\"budget_seconds\":%.3f,\"cost\":%.17g,\"target\":%.17g,\"seconds_to_target\":%.6e,\"improvements\":%zu}\n",
+                    graph.c_str(), lat::numnodes(G), lat::nnz(G), omp_get_max_threads(), names[r].c_str(),
+                    seconds, traces[r].back().second, target, to_target, traces[r].size() - 1);
+
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char * argv[]) {
+    const double scale = argc > 1 ? std::stod(argv[1]) : 1.;
+
+    for (const double base : {1024., 4096., 16384.}) {
+        const Z n = std::max(8., base * scale);
+
+        const Z side2 = std::lround(std::sqrt(n)), side3 = std::lround(std::cbrt(n));
+
+        run("grid_2d", lat::grid_2d<R, Z>(side2));
+
+        run("grid_3d", lat::grid_3d<R, Z>(side3));
+
+        run("random_geometric", lat::random_geometric<R, Z>(n, std::sqrt(8. / (3.14159265358979 * n)), 1));
+
+        const lat::Graph<R, Z> P = lat::power_law<R, Z>(n, 3, 2);
+
+        run("power_law", P);
+
+        scale_threads("multilevel_sequence", "power_law", P, n, true, [&] { return lat::la(P(lat::multilevel_sequence(P))); });
+
+        race("power_law", P, 1.);
+
+        run("banded", lat::banded<R, Z>(n, 16, .5, 3));
+    }
+
+    return 0;
+}
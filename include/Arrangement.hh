@@ -0,0 +1,218 @@
+// "Arrangement.hh" -- implements template class Arrangement as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef ARRANGEMENT_HH
+#define ARRANGEMENT_HH
+
+#include "Graph.hh"
+#include "swap_delta.hh"
+
+namespace lat {
+
+// A view of G laid out along a (possibly partial) sequence. Reads G through p
+// and its inverse q instead of materialising G(p); q[v] is - 1 for nodes that
+// have not been placed. G must outlive the view. weights and offset are those
+// of G (see Graph).
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+class Arrangement final {
+public:
+    Arrangement(const Graph<real, integer, weights, offset> & _G, const std::vector<integer> & _p) :
+    G{_G}, p{_p}, q{positions(_p, numnodes(_G))} { ; }
+
+    const integer operator[](const integer i) const { return p[i]; }
+
+    const integer position(const integer v) const { return q[v]; }
+
+    const integer size() const { return p.size(); }
+
+    const Graph<real, integer, weights, offset> & graph() const { return G; }
+
+    const std::vector<integer> & sequence() const { return p; }
+
+    const std::vector<integer> & inverse() const { return q; }
+
+    // Exchanges the nodes at positions i and j, O(1).
+    void swap(const integer i, const integer j) {
+        std::swap(p[i], p[j]);
+
+        q[p[i]] = i; q[p[j]] = j;
+    }
+
+    // std::rotate of positions [first, last) so that middle becomes first, O(last - first).
+    void rotate(const integer first, const integer middle, const integer last) {
+        std::rotate(p.begin() + first, p.begin() + middle, p.begin() + last);
+
+        for (integer i = first; i < last; i++) {
+            q[p[i]] = i;
+        }
+    }
+
+    // Moves the node at position from to position to, shifting the nodes in between, O(|to - from|).
+    void insert(const integer from, const integer to) {
+        if (from < to) {
+            rotate(from, from + 1, to + 1);
+        }
+        else if (to < from) {
+            rotate(to, from, from + 1);
+        }
+    }
+
+    // Places node v after the last position of a partial arrangement, O(1).
+    void push_back(const integer v) {
+        q[v] = p.size();
+
+        p.push_back(v);
+    }
+
+    template<typename R, typename Z, typename W, typename O>
+    friend const R la(const Arrangement<R, Z, W, O> & P);
+
+    template<typename R, typename Z, typename W, typename O>
+    friend const R stable_la(const Arrangement<R, Z, W, O> & P);
+
+    void print() const;
+
+    ~Arrangement() { ; }
+
+private:
+    const Graph<real, integer, weights, offset> & G;
+
+    std::vector<integer> p, q;
+};
+
+template<typename R, typename Z, typename W, typename O>
+const R la(const Arrangement<R, Z, W, O> & P) {
+    const auto & A = values(P.G);
+
+    const Array<Z> & IA = row_indices(P.G);
+
+    const Array<O> & JA = col_ptrs(P.G);
+
+    const std::vector<Z> & p = P.p, & q = P.q;
+
+    const Z cols = p.size();
+
+    R total_cost = .0;
+
+    for (Z j = 0; j < cols; j++) {
+        const O ub = JA[p[j] + 1], lb = JA[p[j]];
+
+        for (O i = lb; i < ub; i++) {
+            const Z qi = q[IA[i]];
+
+            if (qi > - 1) {
+                total_cost += A[i] * std::fabs(j - qi);
+            }
+        }
+    }
+
+    return half_stored(P.G) ? 2 * total_cost : total_cost;
+}
+
+template<typename R, typename Z, typename W, typename O>
+const R parallel_la(const Arrangement<R, Z, W, O> & P) {
+    const auto & A = values(P.graph());
+
+    const Array<Z> & IA = row_indices(P.graph());
+
+    const Array<O> & JA = col_ptrs(P.graph());
+
+    const std::vector<Z> & p = P.sequence(), & q = P.inverse();
+
+    const Z cols = p.size();
+
+    R total_cost = .0;
+
+#   pragma omp parallel for reduction(+ : total_cost) schedule(guided)
+    for (Z j = 0; j < cols; j++) {
+        const O ub = JA[p[j] + 1], lb = JA[p[j]];
+
+        for (O i = lb; i < ub; i++) {
+            const Z qi = q[IA[i]];
+
+            if (qi > - 1) {
+                total_cost += A[i] * std::fabs(j - qi);
+            }
+        }
+    }
+
+    return half_stored(P.graph()) ? 2 * total_cost : total_cost;
+}
+
+template<typename R, typename Z, typename W, typename O>
+const R stable_la(const Arrangement<R, Z, W, O> & P) {
+    const auto & A = values(P.G);
+
+    const Array<Z> & IA = row_indices(P.G);
+
+    const Array<O> & JA = col_ptrs(P.G);
+
+    const std::vector<Z> & p = P.p, & q = P.q;
+
+    const Z cols = p.size();
+
+    R total_cost = .0, c = .0;
+
+    for (Z j = 0; j < cols; j++) {
+        const O ub = JA[p[j] + 1], lb = JA[p[j]];
+
+        for (O i = lb; i < ub; i++) {
+            const Z qi = q[IA[i]];
+
+            if (qi > - 1) {
+                compensated_add(total_cost, c, A[i] * std::fabs(j - qi));
+            }
+        }
+    }
+
+    return half_stored(P.G) ? 2 * (total_cost + c) : total_cost + c;
+}
+
+template<typename real, typename integer, typename weights, typename offset>
+void Arrangement<real, integer, weights, offset>::print() const {
+    const auto & A = values(G);
+
+    const Array<integer> & IA = row_indices(G);
+
+    const Array<offset> & JA = col_ptrs(G);
+
+    const integer cols = p.size();
+
+    for (integer j = 0; j < cols; j++) {
+        const offset ub = JA[p[j] + 1], lb = JA[p[j]];
+
+        for (offset i = lb; i < ub; i++) {
+            const integer qi = q[IA[i]];
+
+            if (qi > - 1) {
+                std::cout << "(" << qi << ", " << j << ")\t" << A[i] << "\n";
+            }
+        }
+    }
+}
+
+template<typename R, typename Z, typename W, typename O>
+const R swap_delta(const Graph<R, Z, W, O> & S, const Arrangement<R, Z, W, O> & P, const Z i, const Z j) {
+    return swap_delta(S, P.sequence(), P.inverse(), i, j);
+}
+
+}
+
+#endif
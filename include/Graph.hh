@@ -27,256 +27,638 @@
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <cstdlib>
 #include <cassert>
+#include <memory>
+#include <utility>
 #include <omp.h>
 
 namespace lat {
 
-template<typename real, typename integer>
+// Read-only contiguous storage of one Graph array. It either owns a vector, or
+// borrows memory that is kept alive by keep (e.g. a file mapping) so a Graph
+// can work on arrays it did not allocate. Copies of a borrowed Array share it.
+template<typename T>
+class Array final {
+public:
+    Array() : ptr{nullptr}, n{0} { ; }
+
+    Array(const std::vector<T> & v) : owned{v}, ptr{owned.data()}, n{owned.size()} { ; }
+
+    Array(std::vector<T> && v) : owned{std::move(v)}, ptr{owned.data()}, n{owned.size()} { ; }
+
+    Array(const T * _ptr, const std::size_t _n, std::shared_ptr<const void> _keep) :
+    ptr{_ptr}, n{_n}, keep{std::move(_keep)} { ; }
+
+    Array(const Array<T> & _a) :
+    owned{_a.owned}, ptr{_a.keep ? _a.ptr : owned.data()}, n{_a.n}, keep{_a.keep} { ; }
+
+    Array(Array<T> && _a) :
+    owned{std::move(_a.owned)}, ptr{_a.keep ? _a.ptr : owned.data()}, n{_a.n}, keep{std::move(_a.keep)} {
+        _a.ptr = nullptr; _a.n = 0;
+    }
+
+    Array<T> & operator=(Array<T> _a) {
+        owned.swap(_a.owned); keep.swap(_a.keep);
+
+        ptr = keep ? _a.ptr : owned.data(); n = _a.n;
+
+        return (*this);
+    }
+
+    const T & operator[](const std::size_t i) const { return ptr[i]; }
+
+    const T * begin() const { return ptr; }
+
+    const T * end() const { return ptr + n; }
+
+    const T * data() const { return ptr; }
+
+    std::size_t size() const { return n; }
+
+    bool borrowed() const { return static_cast<bool>(keep); }
+
+    ~Array() { ; }
+
+private:
+    std::vector<T> owned;
+
+    const T * ptr;
+
+    std::size_t n;
+
+    std::shared_ptr<const void> keep;
+};
+
+// Values of a pattern graph: n entries that all read as one and take no memory.
+template<typename T>
+class Unit_Array final {
+public:
+    Unit_Array(const std::size_t _n = 0) : n{_n} { ; }
+
+    T operator[](const std::size_t) const { return T(1); }
+
+    std::size_t size() const { return n; }
+
+    bool borrowed() const { return false; }
+
+    ~Unit_Array() { ; }
+
+private:
+    std::size_t n;
+};
+
+// Weight policies of Graph, chosen at compile time. Stored_Weights keeps one
+// value per entry in A; Unit_Weights is for unweighted (pattern) graphs, whose
+// A stores nothing and reads as ones, so la() never loads a value.
+struct Stored_Weights final {
+    static constexpr bool stored = true;
+
+    template<typename T>
+    using array = Array<T>;
+};
+
+struct Unit_Weights final {
+    static constexpr bool stored = false;
+
+    template<typename T>
+    using array = Unit_Array<T>;
+};
+
+// Raw access to stored values for the vectorised kernels; unit values pass through.
+template<typename T>
+inline const T * value_data(const Array<T> & A) {
+    return A.data();
+}
+
+template<typename T>
+inline const Unit_Array<T> & value_data(const Unit_Array<T> & A) {
+    return A;
+}
+
+// Output buffers of permute(), plus its inverse permutation scratch. They only
+// grow, so permuting repeatedly into the same Workspace stops allocating once
+// it has seen the largest graph. A stays empty for pattern graphs.
+template<typename real, typename integer, typename offset = integer>
+struct Workspace final {
+    std::vector<real> A;
+
+    std::vector<integer> IA, h;
+
+    std::vector<offset> JA;
+};
+
+// A graph in compressed sparse column form. weights is Stored_Weights or
+// Unit_Weights; offset is the type of the column pointers JA, which may be
+// wider than the row indices (e.g. 32 bit IA with 64 bit JA once nnz outgrows
+// the node count's type). Constructors taking A ignore it for pattern graphs,
+// and those without A give a Stored_Weights graph unit weights.
+// A half stored graph keeps one entry per off-diagonal pair, as the "symmetric"
+// Matrix Market files do, and stands for the matrix with each of them mirrored:
+// la() counts them twice and symmetrize() returns the same graph as for the
+// full matrix, so every cost is that of the full matrix at half the entries.
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
 class Graph final {
 public:
+    using values_type = typename weights::template array<real>;
+
     Graph(const std::vector<real> & _A, 
           const std::vector<integer> & _IA, 
-          const std::vector<integer> & _JA,
-          const integer _rows, const integer _cols) : 
-    A{_A}, IA{_IA}, JA{_JA}, rows{_rows}, cols{_cols} { ; }
+          const std::vector<offset> & _JA,
+          const integer _rows, const integer _cols, const bool _half = false) : 
+    A{make_values(_A, _IA.size())}, IA{_IA}, JA{_JA}, rows{_rows}, cols{_cols}, half{_half} { ; }
+
+    Graph(std::vector<real> && _A, 
+          std::vector<integer> && _IA, 
+          std::vector<offset> && _JA,
+          const integer _rows, const integer _cols, const bool _half = false) : 
+    A{make_values(std::move(_A), _IA.size())}, IA{std::move(_IA)}, JA{std::move(_JA)}, rows{_rows}, cols{_cols}, half{_half} { ; }
+
+    Graph(Array<real> && _A, 
+          Array<integer> && _IA, 
+          Array<offset> && _JA,
+          const integer _rows, const integer _cols, const bool _half = false) : 
+    A{make_values(std::move(_A), _IA.size())}, IA{std::move(_IA)}, JA{std::move(_JA)}, rows{_rows}, cols{_cols}, half{_half} { ; }
+
+    Graph(const std::vector<integer> & _IA, 
+          const std::vector<offset> & _JA,
+          const integer _rows, const integer _cols, const bool _half = false) : 
+    A{unit_values(_IA.size())}, IA{_IA}, JA{_JA}, rows{_rows}, cols{_cols}, half{_half} { ; }
+
+    Graph(std::vector<integer> && _IA, 
+          std::vector<offset> && _JA,
+          const integer _rows, const integer _cols, const bool _half = false) : 
+    A{unit_values(_IA.size())}, IA{std::move(_IA)}, JA{std::move(_JA)}, rows{_rows}, cols{_cols}, half{_half} { ; }
+
+    Graph(Array<integer> && _IA, 
+          Array<offset> && _JA,
+          const integer _rows, const integer _cols, const bool _half = false) : 
+    A{unit_values(_IA.size())}, IA{std::move(_IA)}, JA{std::move(_JA)}, rows{_rows}, cols{_cols}, half{_half} { ; }
+
+    Graph(const Graph<real, integer, weights, offset> & _G) : 
+    A{_G.A}, IA{_G.IA}, JA{_G.JA}, rows{_G.rows}, cols{_G.cols}, half{_G.half} { ; }
+
+    Graph(Graph<real, integer, weights, offset> && _G) : 
+    A{std::move(_G.A)}, IA{std::move(_G.IA)}, JA{std::move(_G.JA)}, rows{_G.rows}, cols{_G.cols}, half{_G.half} { ; }
+
+    Graph<real, integer, weights, offset> & operator=(const Graph<real, integer, weights, offset> & _G) {
+        A = _G.A; IA = _G.IA; JA = _G.JA;
 
-    Graph(const Graph<real, integer> & _G) : 
-    A{_G.A}, IA{_G.IA}, JA{_G.JA}, rows{_G.rows}, cols{_G.cols} { ; }
+        rows = _G.rows; cols = _G.cols; half = _G.half;
 
-    Graph<real, integer> & operator=(const Graph<real, integer> & _G) {
-        A = _G.A; IA = _G.IA; JA = _G.JA;
+        return (*this);
+    }
+
+    Graph<real, integer, weights, offset> & operator=(Graph<real, integer, weights, offset> && _G) {
+        A = std::move(_G.A); IA = std::move(_G.IA); JA = std::move(_G.JA);
 
-        rows = _G.rows; cols = _G.cols;
+        rows = _G.rows; cols = _G.cols; half = _G.half;
 
         return (*this);
     }
 
-    const Graph<real, integer> operator()(const std::vector<integer> & p) const {
-        Graph<real, integer> res{*this};
+    const Graph<real, integer, weights, offset> operator()(const std::vector<integer> & p) const {
+        Workspace<real, integer, offset> W;
 
-        return res.perm(p);
+        permute(*this, p, W);
+
+        const integer n = p.size();
+
+        return Graph<real, integer, weights, offset>(std::move(W.A), std::move(W.IA), std::move(W.JA), n, n, half);
     }
 
-    template<typename R, typename Z>
-    friend const Z nnz(const Graph<R, Z> & G);
+    template<typename R, typename Z, typename W, typename O>
+    friend const O nnz(const Graph<R, Z, W, O> & G);
+
+    template<typename R, typename Z, typename W, typename O>
+    friend const Z numnodes(const Graph<R, Z, W, O> & G);
+
+    template<typename R, typename Z, typename W, typename O>
+    friend const Z numrows(const Graph<R, Z, W, O> & G);
+
+    template<typename R, typename Z, typename W, typename O>
+    friend bool half_stored(const Graph<R, Z, W, O> & G);
 
-    template<typename R, typename Z>
-    friend const Z numnodes(const Graph<R, Z> & G);
+    template<typename R, typename Z, typename W, typename O>
+    friend const typename W::template array<R> & values(const Graph<R, Z, W, O> & G);
 
-    template<typename R, typename Z>
-    friend const R la(const Graph<R, Z> & G);
+    template<typename R, typename Z, typename W, typename O>
+    friend const Array<Z> & row_indices(const Graph<R, Z, W, O> & G);
 
-    template<typename R, typename Z>
-    friend const R stable_la(const Graph<R, Z> & G);
+    template<typename R, typename Z, typename W, typename O>
+    friend const Array<O> & col_ptrs(const Graph<R, Z, W, O> & G);
+
+    template<typename R, typename Z, typename W, typename O>
+    friend const R la(const Graph<R, Z, W, O> & G);
+
+    template<typename R, typename Z, typename W, typename O>
+    friend const R stable_la(const Graph<R, Z, W, O> & G);
 
     void print() const;
         
     ~Graph() { ; }
 
 private:
-    std::vector<real> A;
+    values_type A;
 
-    std::vector<integer> IA, JA;
+    Array<integer> IA;
+
+    Array<offset> JA;
 
     integer rows, cols;
 
-    Graph<real, integer> & c_perm(const std::vector<integer> & p); 
+    bool half;
 
-    Graph<real, integer> & r_perm(const std::vector<integer> & p); 
+    template<typename V>
+    static values_type make_values(V && _A, const std::size_t n) {
+        if constexpr (weights::stored) {
+            return values_type(std::forward<V>(_A));
+        }
+        else {
+            return values_type(n);
+        }
+    }
 
-    Graph<real, integer> & perm(const std::vector<integer> & p) {
-        return (*this).c_perm(p).r_perm(p);
+    static values_type unit_values(const std::size_t n) {
+        return make_values(std::vector<real>(weights::stored ? n : 0, 1.), n);
     }
 
-    Graph<real, integer> & perm(const std::vector<integer> & rp, const std::vector<integer> & cp) {
-        return (*this).c_perm(cp).r_perm(rp);
+    Graph<real, integer, weights, offset> & perm(const std::vector<integer> & p) {
+        return (*this) = (*this)(p);
     }
 };
 
+template<typename R, typename Z, typename W, typename O>
+const O nnz(const Graph<R, Z, W, O> & G) {
+    return G.IA.size();
+}
+
+template<typename R, typename Z, typename W, typename O>
+const Z numnodes(const Graph<R, Z, W, O> & G) {
+    return G.cols;
+}
+
+template<typename R, typename Z, typename W, typename O>
+const Z numrows(const Graph<R, Z, W, O> & G) {
+    return G.rows;
+}
 
-template<typename real, typename integer>
-Graph<real, integer> & Graph<real, integer>::c_perm(const std::vector<integer> & p) {
-    const integer pcols = p.size();
+template<typename R, typename Z, typename W, typename O>
+bool half_stored(const Graph<R, Z, W, O> & G) {
+    return G.half;
+}
 
-    std::vector<integer> resJA(pcols + 1);
-                
-    resJA[0] = 0;
+template<typename R, typename Z, typename W, typename O>
+const typename W::template array<R> & values(const Graph<R, Z, W, O> & G) {
+    return G.A;
+}
 
-    for (integer j = 0; j < pcols; j++) {
-        const integer pj = p[j];
+template<typename R, typename Z, typename W, typename O>
+const Array<Z> & row_indices(const Graph<R, Z, W, O> & G) {
+    return G.IA;
+}
 
-        const integer ub = JA[pj + 1], lb = JA[pj];
+template<typename R, typename Z, typename W, typename O>
+const Array<O> & col_ptrs(const Graph<R, Z, W, O> & G) {
+    return G.JA;
+}
 
-        resJA[j + 1] = (ub - lb);
-    }
+// Returns the undirected adjacency of G, i.e. the pattern of A + A^T with the
+// diagonal dropped and duplicate entries merged. Column v lists every neighbour
+// of node v once, weighted by the total weight of the entries joining them.
+// A pattern graph cannot carry merged weights, so there every entry of G
+// stays a separate unit entry, once in each direction. The entries of a half
+// stored G count for both of their mirrored pairs, doubled or twice over.
+template<typename R, typename Z, typename W, typename O>
+const Graph<R, Z, W, O> symmetrize(const Graph<R, Z, W, O> & G) {
+    const auto & A = values(G);
 
-    std::partial_sum(resJA.begin(), resJA.end(), resJA.begin());
-                        
-    const integer nonzeros = resJA[pcols];
+    const Array<Z> & IA = row_indices(G);
 
-    std::vector<real> resA(nonzeros);
+    const Array<O> & JA = col_ptrs(G);
 
-    std::vector<integer> resIA(nonzeros);
+    const Z n = numnodes(G);
 
-    for (integer j = 0; j < pcols; j++) {
-        const integer pj = p[j];
+    const O copies = half_stored(G) && !W::stored ? 2 : 1;
 
-        const integer ub = JA[pj + 1], lb1 = JA[pj], lb2 = resJA[j];
+    const R scale = half_stored(G) ? 2 : 1;
 
-        std::copy(A.begin() + lb1, A.begin() + ub, resA.begin() + lb2);
+    std::vector<O> resJA(n + 1, 0);
 
-        std::copy(IA.begin() + lb1, IA.begin() + ub, resIA.begin() + lb2);
+    for (Z j = 0; j < n; j++) {
+        const O ub = JA[j + 1], lb = JA[j];
+
+        for (O i = lb; i < ub; i++) {
+            if (IA[i] != j) {
+                resJA[j + 1] += copies; resJA[IA[i] + 1] += copies;
+            }
+        }
     }
-    
-    A = std::move(resA); IA = std::move(resIA); JA = std::move(resJA); cols = pcols;
 
-    return (*this);
-}
+    std::partial_sum(resJA.begin(), resJA.end(), resJA.begin());
+
+    std::vector<R> resA(W::stored ? resJA[n] : 0);
+
+    std::vector<Z> resIA(resJA[n]);
 
-template<typename real, typename integer>
-Graph<real, integer> & Graph<real, integer>::r_perm(const std::vector<integer> & p) {
-    const integer prows = p.size();
+    std::vector<O> next(resJA.begin(), resJA.end() - 1);
 
-    if (prows < rows) {
+    for (Z j = 0; j < n; j++) {
+        const O ub = JA[j + 1], lb = JA[j];
 
-    std::vector<integer> h(rows, - 1);
+        for (O i = lb; i < ub; i++) {
+            const Z r = IA[i];
 
-    for (integer i = 0; i < prows; i++) {
-        h[p[i]] = i;
+            for (O c = 0; c < copies && r != j; c++) {
+                if constexpr (W::stored) {
+                    resA[next[j]] = scale * A[i]; resA[next[r]] = scale * A[i];
+                }
+
+                resIA[next[j]++] = r; resIA[next[r]++] = j;
+            }
+        }
     }
-    
-    const integer nonzeros = IA.size();
 
-    std::vector<integer> resIA(nonzeros);
+    if constexpr (!W::stored) {
+        return Graph<R, Z, W, O>(std::move(resIA), std::move(resJA), n, n);
+    }
+
+    std::vector<O> mark(n, - 1);
+
+    O top = 0, lb = 0;
 
-    std::vector<real> resA(nonzeros, - 1);
+    for (Z j = 0; j < n; j++) {
+        const O ub = resJA[j + 1], start = top;
 
-    for (integer i = 0; i < nonzeros; i++) {
-        auto hIAi = h[IA[i]];
+        for (O i = lb; i < ub; i++) {
+            const Z r = resIA[i];
 
-        resIA[i] = hIAi;
+            if (mark[r] < start) {
+                mark[r] = top;
 
-        if (hIAi > - 1) {
-            resA[i] = A[i];
+                resIA[top] = r; resA[top++] = resA[i];
+            }
+            else {
+                resA[mark[r]] += resA[i];
+            }
         }
+
+        resJA[j + 1] = top; lb = ub;
     }
 
-    std::vector<integer> resJA(cols + 1);
+    resIA.resize(top); resA.resize(top);
 
-    resJA[0] = 0;
+    return Graph<R, Z, W, O>(std::move(resA), std::move(resIA), std::move(resJA), n, n);
+}
 
-    for (integer j = 1; j <= cols; j++) {
-        const integer ub = JA[j], lb = JA[j - 1];
+// Cost of the entries lb to ub of column j. Written as a plain reduction over
+// contiguous arrays so the compiler can emit AVX2/AVX-512 code for it when the
+// target allows, and scalar code otherwise.
+template<typename R, typename Z, typename O>
+inline R column_la(const R * A, const Z * IA, const O lb, const O ub, const Z j) {
+    const R rj = j;
 
-        const integer elements = std::count_if(resIA.begin() + lb, resIA.begin() + ub, [] (integer i) {
-                                                                                           return i > - 1;
-                                                                                       });
-        resJA[j] = elements;
+    R cost = .0;
+
+#   pragma omp simd reduction(+ : cost)
+    for (O i = lb; i < ub; i++) {
+        cost += A[i] * std::fabs(rj - IA[i]);
     }
 
-    std::partial_sum(resJA.begin(), resJA.end(), resJA.begin());
+    return cost;
+}
+
+// The same for a pattern graph, which has no values to load.
+template<typename R, typename Z, typename O>
+inline R column_la(const Unit_Array<R> &, const Z * IA, const O lb, const O ub, const Z j) {
+    const R rj = j;
 
-    resIA.erase(std::remove(resIA.begin(), resIA.end(), - 1), resIA.end());
+    R cost = .0;
 
-    resA.erase(std::remove(resA.begin(), resA.end(), - 1), resA.end());
+#   pragma omp simd reduction(+ : cost)
+    for (O i = lb; i < ub; i++) {
+        cost += std::fabs(rj - IA[i]);
+    }
+
+    return cost;
+}
 
-    A = std::move(resA); IA = std::move(resIA); JA = std::move(resJA); rows = prows;
+// Adds x to sum with Neumaier's compensation carried in c; the rounding error
+// of the whole series stays O(eps) independent of its length.
+template<typename R>
+inline void compensated_add(R & sum, R & c, const R x) {
+    const R t = sum + x;
 
+    if (std::fabs(sum) >= std::fabs(x)) {
+        c += (sum - t) + x;
     }
     else {
+        c += (x - t) + sum;
+    }
 
-    std::vector<integer> h(rows);
+    sum = t;
+}
 
-    for (integer i = 0; i < rows; i++) {
-        h[p[i]] = i;
-    }
-    
-    const integer nonzeros = nnz(*this);
+// Symmetric permutation G(p) in a single pass, parallel over columns, written
+// into W.A, W.IA and W.JA. Nodes missing from a partial p are dropped together
+// with their entries. With sort_rows the row indices of every column come out
+// ascending, as most sparse direct solvers expect; otherwise they keep the
+// order of G.
+template<typename R, typename Z, typename V, typename O>
+void permute(const Graph<R, Z, V, O> & G, const std::vector<Z> & p, Workspace<R, Z, O> & W, const bool sort_rows = false) {
+    const auto & A = values(G);
+
+    const Array<Z> & IA = row_indices(G);
+
+    const Array<O> & JA = col_ptrs(G);
+
+    const Z n = p.size(), rows = numrows(G);
+
+    const bool partial = n < rows;
+
+    W.h.assign(rows, - 1);
+
+    W.JA.resize(n + 1);
+
+    std::vector<Z> & h = W.h;
 
-    std::vector<integer> resIA(nonzeros);
+    std::vector<O> & resJA = W.JA;
 
-    for (integer i = 0; i < nonzeros; i++) {
-        resIA[i] = h[IA[i]];
+#   pragma omp parallel for
+    for (Z j = 0; j < n; j++) {
+        h[p[j]] = j;
     }
 
-    IA = std::move(resIA);
+    resJA[0] = 0;
+
+#   pragma omp parallel for schedule(guided)
+    for (Z j = 0; j < n; j++) {
+        const O ub = JA[p[j] + 1], lb = JA[p[j]];
+
+        O count = ub - lb;
+
+        if (partial) {
+            count = 0;
+
+            for (O i = lb; i < ub; i++) {
+                count += h[IA[i]] > - 1;
+            }
+        }
 
+        resJA[j + 1] = count;
     }
 
-    return (*this);
-}
+    std::partial_sum(resJA.begin(), resJA.end(), resJA.begin());
 
-template<typename R, typename Z>
-const Z nnz(const Graph<R, Z> & G) {
-    return G.A.size();
-}
+    W.A.resize(V::stored ? resJA[n] : 0); W.IA.resize(resJA[n]);
 
-template<typename R, typename Z>
-const Z numnodes(const Graph<R, Z> & G) {
-    return G.cols;
-}
+    R * resA = W.A.data();
 
-template<typename R, typename Z>
-const R la(const Graph<R, Z> & G) {
-    //std::vector<R> costs(nnz(G));
+    Z * resIA = W.IA.data();
 
-    const std::vector<R> & A = G.A;
+#   pragma omp parallel
+    {
+        std::vector<std::pair<Z, R>> column;
 
-    const std::vector<Z> & IA = G.IA;
+#       pragma omp for schedule(guided)
+        for (Z j = 0; j < n; j++) {
+            const O ub = JA[p[j] + 1], lb = JA[p[j]];
 
-    const std::vector<Z> & JA = G.JA;
+            O k = resJA[j];
 
-    const Z cols = G.cols;
+            for (O i = lb; i < ub; i++) {
+                const Z hi = h[IA[i]];
 
-    R total_cost = .0;
+                if (hi > - 1) {
+                    if constexpr (V::stored) {
+                        resA[k] = A[i];
+                    }
 
-    for (Z j = 0; j < cols; j++) {
-        const Z ub = JA[j + 1], lb = JA[j];
+                    resIA[k++] = hi;
+                }
+            }
+
+            if (!V::stored && sort_rows) {
+                std::sort(resIA + resJA[j], resIA + k);
+            }
+            else if (sort_rows && !std::is_sorted(resIA + resJA[j], resIA + k)) {
+                column.clear();
 
-        for (Z i = lb; i < ub; i++) {
-            total_cost += A[i] * std::fabs(j - IA[i]);
+                for (O i = resJA[j]; i < k; i++) {
+                    column.emplace_back(resIA[i], resA[i]);
+                }
+
+                std::sort(column.begin(), column.end(), [] (const std::pair<Z, R> & a, const std::pair<Z, R> & b) {
+                                                            return a.first < b.first;
+                                                        });
+
+                for (O i = resJA[j]; i < k; i++) {
+                    resIA[i] = column[i - resJA[j]].first; resA[i] = column[i - resJA[j]].second;
+                }
+            }
         }
     }
+}
+
+template<typename R, typename Z, typename W, typename O>
+const R la(const Graph<R, Z, W, O> & G) {
+    const auto & A = value_data(G.A);
+
+    const Z * IA = G.IA.data();
 
-    //const R total_cost = std::accumulate(costs.begin(), costs.end(), 0.);
+    const Array<O> & JA = G.JA;
 
-    return total_cost;
+    const Z cols = G.cols;
+
+    R total_cost = .0;
+
+    for (Z j = 0; j < cols; j++) {
+        total_cost += column_la(A, IA, JA[j], JA[j + 1], j);
+    }
+
+    return G.half ? 2 * total_cost : total_cost;
 }
 
-template<typename R, typename Z>
-const R stable_la(const Graph<R, Z> & G) {
-    std::vector<R> costs(nnz(G));
+template<typename R, typename Z, typename W, typename O>
+const R parallel_la(const Graph<R, Z, W, O> & G) {
+    const auto & A = value_data(values(G));
+
+    const Z * IA = row_indices(G).data();
+
+    const Array<O> & JA = col_ptrs(G);
+
+    const Z cols = numnodes(G);
 
-    const std::vector<R> & A = G.A;
+    R total_cost = .0;
+
+#   pragma omp parallel for reduction(+ : total_cost) schedule(guided)
+    for (Z j = 0; j < cols; j++) {
+        total_cost += column_la(A, IA, JA[j], JA[j + 1], j);
+    }
+
+    return half_stored(G) ? 2 * total_cost : total_cost;
+}
+
+// Accurate la with compensated summation, O(nnz) without extra storage.
+template<typename R, typename Z, typename W, typename O>
+const R stable_la(const Graph<R, Z, W, O> & G) {
+    const auto & A = G.A;
 
-    const std::vector<Z> & IA = G.IA;
+    const Array<Z> & IA = G.IA;
 
-    const std::vector<Z> & JA = G.JA;
+    const Array<O> & JA = G.JA;
 
     const Z cols = G.cols;
 
+    R total_cost = .0, c = .0;
+
     for (Z j = 0; j < cols; j++) {
-        const Z ub = JA[j + 1], lb = JA[j];
+        const O ub = JA[j + 1], lb = JA[j];
 
-        for (Z i = lb; i < ub; i++) {
-            costs[i] = A[i] * std::fabs(j - IA[i]);
+        for (O i = lb; i < ub; i++) {
+            compensated_add(total_cost, c, A[i] * std::fabs(j - IA[i]));
         }
     }
 
-    std::sort(costs.begin(), costs.end());
+    return G.half ? 2 * (total_cost + c) : total_cost + c;
+}
+
+// Exact la of a unit-weight graph: sums |j - IA[i]| in 64 bit integers and never reads A.
+template<typename R, typename Z, typename W, typename O>
+long long pattern_la(const Graph<R, Z, W, O> & G) {
+    const Z * IA = row_indices(G).data();
 
-    const R total_cost = std::accumulate(costs.begin(), costs.end(), 0.);
+    const Array<O> & JA = col_ptrs(G);
+
+    const Z cols = numnodes(G);
+
+    long long total_cost = 0;
+
+#   pragma omp parallel for reduction(+ : total_cost) schedule(guided)
+    for (Z j = 0; j < cols; j++) {
+        const O ub = JA[j + 1], lb = JA[j];
+
+        const long long lj = j;
+
+        long long cost = 0;
+
+#       pragma omp simd reduction(+ : cost)
+        for (O i = lb; i < ub; i++) {
+            cost += std::abs(lj - IA[i]);
+        }
+
+        total_cost += cost;
+    }
 
-    return total_cost;
+    return half_stored(G) ? 2 * total_cost : total_cost;
 }
 
-template<typename real, typename integer>
-void Graph<real, integer>::print() const {
+template<typename real, typename integer, typename weights, typename offset>
+void Graph<real, integer, weights, offset>::print() const {
     for (integer j = 0; j < cols; j++) {
-        const integer ub = JA[j + 1], lb = JA[j];
+        const offset ub = JA[j + 1], lb = JA[j];
 
-        for (integer i = lb; i < ub; i++) {
+        for (offset i = lb; i < ub; i++) {
             std::cout << "(" << IA[i] << ", " << j << ")\t" << A[i] << "\n";                
         }
     }
@@ -0,0 +1,329 @@
+// "annealing.hh" -- implements template functions simulated_annealing and parallel_tempering as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef ANNEALING_HH
+#define ANNEALING_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "budget.hh"
+#include <random>
+#include <cassert>
+#include <cmath>
+
+namespace lat {
+
+enum class Cooling { geometric, linear, lundy_mees };
+
+// Moves are a swap of two nodes, or the insertion of one node at another
+// position, at most reach positions apart. A swap is scored in O(deg) and an
+// insertion, as a chain of adjacent swaps, in O(reach * deg). An initial
+// temperature of 0 is replaced by one that accepts an average uphill move
+// with probability 1 / 2; the final temperature is relative to the initial.
+template<typename R>
+struct Schedule final {
+    Cooling cooling = Cooling::geometric;
+
+    R initial_temperature = 0, final_ratio = 1e-3;
+
+    unsigned long long moves = 1000000;
+
+    R swap_probability = .5;
+
+    int reach = 16;
+
+    unsigned long long seed = 2019;
+};
+
+template<typename R>
+R temperature(const Schedule<R> & schedule, const R T0, const unsigned long long move) {
+    const R T1 = T0 * schedule.final_ratio, t = static_cast<R>(move) / schedule.moves;
+
+    switch (schedule.cooling) {
+        case Cooling::linear : {
+            return T0 + (T1 - T0) * t;
+        }
+        case Cooling::lundy_mees : {
+            const R beta = (T0 - T1) / (schedule.moves * T0 * T1);
+
+            return T0 / (1 + beta * move * T0);
+        }
+        default : {
+            return T0 * std::pow(schedule.final_ratio, t);
+        }
+    }
+}
+
+// Proposes one random move on P and applies it. Returns its cost change; the
+// caller undoes rejected moves with undo_move().
+template<typename R, typename Z, typename W, typename O, typename Engine>
+R apply_random_move(const Graph<R, Z, W, O> & S, Arrangement<R, Z, W, O> & P, const Schedule<R> & schedule, Engine & engine,
+                    Z & from, Z & to, bool & is_swap) {
+    const Z n = P.size();
+
+    std::uniform_int_distribution<Z> any(0, n - 1);
+
+    std::uniform_int_distribution<Z> offset(1, std::max<Z>(1, std::min<Z>(schedule.reach, n - 1)));
+
+    std::uniform_real_distribution<R> uniform(0, 1);
+
+    from = any(engine);
+
+    const Z d = std::min(offset(engine), std::max(from, n - 1 - from));
+
+    to = (uniform(engine) < .5 && from - d >= 0) || from + d >= n ? from - d : from + d;
+
+    is_swap = uniform(engine) < schedule.swap_probability;
+
+    if (is_swap) {
+        const R delta = swap_delta(S, P, from, to);
+
+        P.swap(from, to);
+
+        return delta;
+    }
+
+    R delta = .0;
+
+    const Z step = to > from ? 1 : - 1;
+
+    for (Z i = from; i != to; i += step) {
+        delta += swap_delta(S, P, i, i + step);
+
+        P.swap(i, i + step);
+    }
+
+    return delta;
+}
+
+template<typename R, typename Z, typename W, typename O>
+void undo_move(Arrangement<R, Z, W, O> & P, const Z from, const Z to, const bool is_swap) {
+    if (is_swap) {
+        P.swap(from, to);
+    }
+    else {
+        P.insert(to, from);
+    }
+}
+
+template<typename R, typename Z, typename W, typename O>
+void redo_move(Arrangement<R, Z, W, O> & P, const Z from, const Z to, const bool is_swap) {
+    if (is_swap) {
+        P.swap(from, to);
+    }
+    else {
+        P.insert(from, to);
+    }
+}
+
+// Average uphill cost change of random moves, for the automatic initial temperature.
+template<typename R, typename Z, typename W, typename O, typename Engine>
+R initial_temperature(const Graph<R, Z, W, O> & S, Arrangement<R, Z, W, O> & P, const Schedule<R> & schedule, Engine & engine) {
+    R uphill = .0;
+
+    Z count = 0, from, to;
+
+    bool is_swap;
+
+    for (Z sample = 0; sample < 1000; sample++) {
+        const R delta = apply_random_move(S, P, schedule, engine, from, to, is_swap);
+
+        undo_move(P, from, to, is_swap);
+
+        if (delta > 0) {
+            uphill += delta; count++;
+        }
+    }
+
+    return count > 0 ? (uphill / count) / std::log(2.) : 1.;
+}
+
+// Runs moves Metropolis steps at temperature(move) on P, whose cost is cost.
+// The best arrangement met is copied to best only when the walk leaves it,
+// i.e. with the uphill move that leaves it taken back for the copy.
+template<typename R, typename Z, typename W, typename O, typename Engine, typename Temperature>
+void metropolis(const Graph<R, Z, W, O> & S, Arrangement<R, Z, W, O> & P, R & cost, const Schedule<R> & schedule, Engine & engine,
+                const unsigned long long first, const unsigned long long last, Temperature temperature,
+                std::vector<Z> & best, R & best_cost, bool & at_best) {
+    std::uniform_real_distribution<R> uniform(0, 1);
+
+    Z from, to;
+
+    bool is_swap;
+
+    for (unsigned long long move = first; move < last; move++) {
+        const R delta = apply_random_move(S, P, schedule, engine, from, to, is_swap);
+
+        if (delta <= 0 || uniform(engine) < std::exp(- delta / temperature(move))) {
+            if (delta > 0 && at_best) {
+                undo_move(P, from, to, is_swap);
+
+                best = P.sequence(); at_best = false;
+
+                redo_move(P, from, to, is_swap);
+            }
+
+            cost += delta;
+
+            if (cost < best_cost) {
+                best_cost = cost; at_best = true;
+            }
+        }
+        else {
+            undo_move(P, from, to, is_swap);
+        }
+    }
+}
+
+// Simulated annealing from sequence; returns the best sequence met. The
+// schedule is cut short once the time of budget runs out or its token is
+// cancelled, which is checked every 4096 moves.
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> simulated_annealing(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, const Schedule<R> & schedule = Schedule<R>{},
+                                   const Budget & budget = Budget{}) {
+    Stopwatch clock;
+
+    if (numnodes(G) < 2) {
+        return sequence;
+    }
+
+    const Graph<R, Z, W, O> S = symmetrize(G);
+
+    Arrangement<R, Z, W, O> P(G, sequence);
+
+    std::mt19937_64 engine(schedule.seed);
+
+    const R T0 = schedule.initial_temperature > 0 ? schedule.initial_temperature : initial_temperature(S, P, schedule, engine);
+
+    R cost = la(P), best_cost = cost;
+
+    std::vector<Z> best = sequence;
+
+    bool at_best = true;
+
+    for (unsigned long long first = 0; first < schedule.moves && !budget.exhausted(clock, 0); first += 4096) {
+        metropolis(S, P, cost, schedule, engine, first, std::min(schedule.moves, first + 4096),
+                   [&] (const unsigned long long move) { return temperature(schedule, T0, move); },
+                   best, best_cost, at_best);
+    }
+
+    const std::vector<Z> & result = at_best ? P.sequence() : best;
+
+    assert(std::fabs(la(Arrangement<R, Z, W, O>(G, result)) - best_cost) <= 1e-9 * std::max(R(1), std::fabs(best_cost)));
+
+    return result;
+}
+
+// Parallel tempering: one replica per temperature of a geometric ladder from
+// T0 down to T0 * final_ratio, run concurrently for rounds of moves / exchanges
+// moves each. Between rounds neighbouring temperatures are offered for exchange
+// with the usual Metropolis criterion; only the replica to temperature map is
+// permuted, so no replica data is copied or locked. Replicas use their own
+// random engines, so the result depends on replicas but not on the number of
+// threads. Returns the best sequence met by any replica.
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> parallel_tempering(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, const Schedule<R> & schedule = Schedule<R>{},
+                                  const Z replicas = omp_get_max_threads(), const Z exchanges = 100) {
+    if (numnodes(G) < 2 || replicas < 1) {
+        return sequence;
+    }
+
+    const Graph<R, Z, W, O> S = symmetrize(G);
+
+    std::vector<Arrangement<R, Z, W, O>> P(replicas, Arrangement<R, Z, W, O>(G, sequence));
+
+    std::vector<std::mt19937_64> engines;
+
+    for (Z r = 0; r < replicas; r++) {
+        engines.emplace_back(schedule.seed + r);
+    }
+
+    const R T0 = schedule.initial_temperature > 0 ? schedule.initial_temperature : initial_temperature(S, P[0], schedule, engines[0]);
+
+    std::vector<R> ladder(replicas), cost(replicas, la(P[0])), best_cost(cost);
+
+    for (Z k = 0; k < replicas; k++) {
+        ladder[k] = replicas > 1 ? T0 * std::pow(schedule.final_ratio, static_cast<R>(k) / (replicas - 1)) : T0;
+    }
+
+    std::vector<Z> rung(replicas);
+
+    std::iota(rung.begin(), rung.end(), 0);
+
+    std::vector<std::vector<Z>> best(replicas, sequence);
+
+    std::vector<char> at_best(replicas, true);
+
+    std::mt19937_64 exchange_engine(schedule.seed + replicas);
+
+    std::uniform_real_distribution<R> uniform(0, 1);
+
+    const unsigned long long round = std::max<unsigned long long>(1, schedule.moves / exchanges);
+
+    for (unsigned long long first = 0; first < schedule.moves; first += round) {
+        const unsigned long long last = std::min(schedule.moves, first + round);
+
+#       pragma omp parallel for schedule(dynamic)
+        for (Z r = 0; r < replicas; r++) {
+            bool replica_at_best = at_best[r];
+
+            const R T = ladder[rung[r]];
+
+            metropolis(S, P[r], cost[r], schedule, engines[r], first, last, [T] (unsigned long long) { return T; },
+                       best[r], best_cost[r], replica_at_best);
+
+            at_best[r] = replica_at_best;
+        }
+
+        std::vector<Z> at_rung(replicas);
+
+        for (Z r = 0; r < replicas; r++) {
+            at_rung[rung[r]] = r;
+        }
+
+        for (Z k = (first / round) % 2; k + 1 < replicas; k += 2) {
+            const Z a = at_rung[k], b = at_rung[k + 1];
+
+            const R exponent = (1 / ladder[k] - 1 / ladder[k + 1]) * (cost[a] - cost[b]);
+
+            if (exponent >= 0 || uniform(exchange_engine) < std::exp(exponent)) {
+                std::swap(rung[a], rung[b]);
+            }
+        }
+    }
+
+    Z winner = 0;
+
+    for (Z r = 1; r < replicas; r++) {
+        if (best_cost[r] < best_cost[winner]) {
+            winner = r;
+        }
+    }
+
+    const std::vector<Z> & result = at_best[winner] ? P[winner].sequence() : best[winner];
+
+    assert(std::fabs(la(Arrangement<R, Z, W, O>(G, result)) - best_cost[winner]) <= 1e-9 * std::max(R(1), std::fabs(best_cost[winner])));
+
+    return result;
+}
+
+}
+
+#endif
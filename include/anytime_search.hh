@@ -0,0 +1,210 @@
+// "anytime_search.hh" -- implements template function anytime_search as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef ANYTIME_SEARCH_HH
+#define ANYTIME_SEARCH_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "load_mtx.hh"
+#include "telemetry.hh"
+#include "budget.hh"
+#include <atomic>
+#include <cstdio>
+#include <tuple>
+
+namespace lat {
+
+// Writes a checkpoint through a temporary file renamed over file_name, so a
+// job killed while writing leaves the previous checkpoint intact.
+template<typename R, typename Z>
+void write_checkpoint(const std::string & file_name, const R cost, const std::vector<Z> & sequence) {
+    const std::string temporary = file_name + ".tmp";
+
+    write_mtx_sequence(temporary, cost, sequence);
+
+    if (std::rename(temporary.c_str(), file_name.c_str()) != 0) {
+        std::cerr << "unable to rename " << temporary << " to " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Sequence to start from: the checkpoint in file_name if it exists and holds
+// a sequence of the same nodes, sequence otherwise.
+template<typename R, typename Z>
+std::vector<Z> resume_sequence(std::string file_name, const std::vector<Z> & sequence) {
+    if (file_name.empty() || !std::ifstream(file_name).good()) {
+        return sequence;
+    }
+
+    std::vector<Z> resumed = load_mtx_sequence<R, Z>(file_name);
+
+    const Z n = sequence.size();
+
+    std::vector<char> seen(n, false);
+
+    bool valid = static_cast<Z>(resumed.size()) == n;
+
+    for (Z i = 0; valid && i < n; i++) {
+        valid = resumed[i] > - 1 && resumed[i] < n && !seen[resumed[i]];
+
+        if (valid) {
+            seen[resumed[i]] = true;
+        }
+    }
+
+    if (!valid) {
+        note("checkpoint ", file_name, " does not match the graph, ignored\n");
+
+        return sequence;
+    }
+
+    return resumed;
+}
+
+// Steepest descent over the 2-swap neighbourhood, as parallel_full_search,
+// that stops as soon as budget is exhausted, even in the middle of a scan:
+// the threads check it after every row and skip the rows left, and the best
+// improving swap of the rows scanned is still applied, or as soon as the cost
+// is within the target gap. Every step improves, so the sequence returned is
+// always the best one found. If budget names a checkpoint that exists the
+// search resumes from it instead of sequence.
+template<typename R, typename Z, typename W, typename O, typename Observer = Null_Observer>
+std::vector<Z> anytime_search(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, const Budget & budget = Budget{},
+                              Observer && observer = Observer{}) {
+    Stopwatch clock;
+
+    const Graph<R, Z, W, O> S = symmetrize(G);
+
+    Arrangement<R, Z, W, O> P(G, resume_sequence<R, Z>(budget.checkpoint, sequence));
+
+    observer.on_phase("symmetrize", clock.split());
+
+    const Z n = numnodes(G);
+
+    const Z m = omp_get_max_threads();
+
+    std::vector<Z> I(m), J(m);
+
+    std::vector<R> min_deltas(m);
+
+    std::vector<unsigned long long> work(m, 0);
+
+    std::atomic<unsigned long long> evaluated{0};
+
+    Progress progress;
+
+    progress.cost = la(P);
+
+    std::atomic<bool> stop{budget.exhausted(clock, 0) || budget.reached(progress.cost)};
+
+    double last_checkpoint = clock.elapsed();
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        clock.stamp(progress);
+
+        observer.on_iteration(progress);
+
+#       pragma omp parallel num_threads(m)
+        {
+            const Z proc = omp_get_thread_num();
+
+            Z ii = 0, jj = 0;
+
+            R min_delta = .0;
+
+#           pragma omp for schedule(monotonic: dynamic) nowait
+            for (Z i = 0; i < n - 1; i++) {
+                if (stop.load(std::memory_order_relaxed)) {
+                    continue;
+                }
+
+                for (Z j = i + 1; j < n; j++) {
+                    const R delta = swap_delta(S, P, i, j);
+
+                    if (delta < min_delta) {
+                        min_delta = delta;
+
+                        ii = i; jj = j;
+                    }
+                }
+
+                work[proc] += n - 1 - i;
+
+                if (budget.exhausted(clock, evaluated.fetch_add(n - 1 - i, std::memory_order_relaxed) + n - 1 - i)) {
+                    stop.store(true, std::memory_order_relaxed);
+                }
+            }
+
+            I[proc] = ii; J[proc] = jj; min_deltas[proc] = min_delta;
+        }
+
+        Z min_idx = 0;
+
+        for (Z proc = 1; proc < m; proc++) {
+            if (std::tie(min_deltas[proc], I[proc], J[proc]) < std::tie(min_deltas[min_idx], I[min_idx], J[min_idx])) {
+                min_idx = proc;
+            }
+        }
+
+        progress.moves_evaluated = evaluated.load();
+
+        if (!(min_deltas[min_idx] < 0)) {
+            break;
+        }
+
+        P.swap(I[min_idx], J[min_idx]);
+
+        progress.iteration++;
+
+        progress.cost += min_deltas[min_idx];
+
+        if (budget.reached(progress.cost)) {
+            stop.store(true);
+        }
+
+        if (!budget.checkpoint.empty() && clock.elapsed() - last_checkpoint >= budget.checkpoint_seconds) {
+            write_checkpoint(budget.checkpoint, progress.cost, P.sequence());
+
+            last_checkpoint = clock.elapsed();
+        }
+    }
+
+    observer.on_phase("search", clock.split());
+
+    if (!budget.checkpoint.empty()) {
+        write_checkpoint(budget.checkpoint, progress.cost, P.sequence());
+    }
+
+    for (Z proc = 0; proc < m; proc++) {
+        observer.on_thread_work(proc, work[proc]);
+    }
+
+    clock.stamp(progress);
+
+    observer.on_finish(progress);
+
+    return P.sequence();
+}
+
+}
+
+#endif
@@ -0,0 +1,419 @@
+// "batch.hh" -- implements template function solve_batch as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef BATCH_HH
+#define BATCH_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "load_mtx.hh"
+#include <condition_variable>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+
+namespace lat {
+
+// One graph of a batch: the .mtx file, where its sequence goes, and the size
+// read from its header.
+struct Batch_Job final {
+    std::string input, output;
+
+    bool pattern = false;
+
+    unsigned long long rows = 0, nonzeros = 0, bytes = 0;
+};
+
+// What solve_batch did with a job; all times are wall seconds. error is empty
+// unless the graph could not be loaded, in which case nothing else is set.
+struct Batch_Result final {
+    std::string input, output, error;
+
+    unsigned long long nodes = 0, nonzeros = 0, bytes = 0;
+
+    double initial_cost = .0, cost = .0, load_seconds = .0, solve_seconds = .0, write_seconds = .0;
+};
+
+// memory_budget bounds the estimated bytes of the graphs loaded at once (0
+// for no bound), workers is the number of graphs solved at once (0 for one per
+// thread) and manifest, if not empty, receives a JSON line per graph.
+struct Batch_Options final {
+    unsigned long long memory_budget = 0;
+
+    int workers = 0;
+
+    std::string manifest;
+};
+
+// Peak memory of loading and solving a graph of the given size: the triplets
+// and the CSC arrays of load_mtx, the symmetrized copy of twice as many
+// entries the solvers make, and a few vectors of nodes.
+template<typename R, typename Z>
+unsigned long long estimated_bytes(const unsigned long long rows, const unsigned long long nonzeros, const bool pattern) {
+    const unsigned long long entry = sizeof(Z) + (pattern ? 0 : sizeof(R));
+
+    return nonzeros * (2 * sizeof(Z) + entry) + nonzeros * entry + 2 * nonzeros * (sizeof(Z) + sizeof(R))
+           + rows * (8 * sizeof(Z) + 4 * sizeof(R));
+}
+
+// Reads only the banner and size line of a coordinate Matrix Market file. A
+// file that cannot be read gives a job of size 0, to fail when loaded.
+template<typename R, typename Z>
+Batch_Job batch_job(const std::string & input, const std::string & output) {
+    std::ifstream fin(input);
+
+    Batch_Job job;
+
+    job.input = input; job.output = output;
+
+    if (!fin.is_open()) {
+        return job;
+    }
+
+    std::string line;
+
+    std::getline(fin, line);
+
+    job.pattern = line.find("pattern") != std::string::npos;
+
+    while (fin.peek() == '%') {
+        fin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    unsigned long long cols = 0;
+
+    if (!(fin >> job.rows >> cols >> job.nonzeros)) {
+        job.rows = job.nonzeros = 0;
+    }
+
+    job.bytes = estimated_bytes<R, Z>(std::max(job.rows, cols), job.nonzeros, job.pattern);
+
+    return job;
+}
+
+// The .mtx files of directory (in name order), each to be written as
+// output_directory/<name>.seq in the write_mtx_sequence format. Exits with
+// a message if directory cannot be listed or output_directory created.
+template<typename R, typename Z>
+std::vector<Batch_Job> batch_jobs(const std::string & directory, const std::string & output_directory) {
+    std::vector<std::filesystem::path> files;
+
+    std::error_code error;
+
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        std::error_code unreadable;
+
+        if (it->is_regular_file(unreadable) && it->path().extension() == ".mtx") {
+            files.push_back(it->path());
+        }
+    }
+
+    if (error) {
+        std::cerr << "unable to list directory : " << directory << " (" << error.message() << ")\n";
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::sort(files.begin(), files.end());
+
+    std::filesystem::create_directories(output_directory, error);
+
+    if (error) {
+        std::cerr << "unable to create directory : " << output_directory << " (" << error.message() << ")\n";
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<Batch_Job> jobs;
+
+    for (const auto & file : files) {
+        const std::filesystem::path output = std::filesystem::path(output_directory) / file.stem().concat(".seq");
+
+        jobs.push_back(batch_job<R, Z>(file.string(), output.string()));
+    }
+
+    return jobs;
+}
+
+// Hands out jobs largest first so that the graphs in flight never exceed
+// the memory budget: acquire() takes the largest job left that fits the
+// budget still free (first fit decreasing, as the jobs arrive at the bins
+// over time). A job larger than the whole budget runs when nothing else is
+// in flight.
+class Batch_Queue final {
+public:
+    Batch_Queue(const std::vector<Batch_Job> & jobs, const unsigned long long budget) :
+    order(jobs.size()), sizes(jobs.size()), taken(jobs.size(), false), limit{budget} {
+        for (std::size_t k = 0; k < jobs.size(); k++) {
+            sizes[k] = jobs[k].bytes;
+        }
+
+        std::iota(order.begin(), order.end(), 0);
+
+        std::stable_sort(order.begin(), order.end(), [this] (const std::size_t a, const std::size_t b) {
+                                                         return sizes[a] > sizes[b];
+                                                     });
+    }
+
+    // Index of the job taken, - 1 once none is left or, if wait is false,
+    // when none fits now.
+    long long acquire(const bool wait) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            bool left = false;
+
+            for (const std::size_t k : order) {
+                if (!taken[k]) {
+                    left = true;
+
+                    if (limit == 0 || in_flight == 0 || in_flight + sizes[k] <= limit) {
+                        taken[k] = true; in_flight += sizes[k];
+
+                        return k;
+                    }
+                }
+            }
+
+            if (!left || !wait) {
+                return - 1;
+            }
+
+            released.wait(lock);
+        }
+    }
+
+    void release(const std::size_t k) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            in_flight -= sizes[k];
+        }
+
+        released.notify_all();
+    }
+
+private:
+    std::vector<std::size_t> order;
+
+    std::vector<unsigned long long> sizes;
+
+    std::vector<char> taken;
+
+    const unsigned long long limit;
+
+    unsigned long long in_flight = 0;
+
+    std::mutex mutex;
+
+    std::condition_variable released;
+};
+
+// s as a JSON string literal.
+inline std::string json_string(const std::string & s) {
+    std::ostringstream quoted;
+
+    quoted << '"';
+
+    for (const unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            quoted << '\\' << c;
+        }
+        else if (c < 0x20) {
+            quoted << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        }
+        else {
+            quoted << c;
+        }
+    }
+
+    quoted << '"';
+
+    return quoted.str();
+}
+
+inline std::string manifest_line(const Batch_Result & r) {
+    std::ostringstream line;
+
+    line << "{\"input\":" << json_string(r.input) << ",\"output\":" << json_string(r.output);
+
+    if (!r.error.empty()) {
+        line << ",\"error\":" << json_string(r.error) << "}\n";
+
+        return line.str();
+    }
+
+    line << std::setprecision(17) << ",\"nodes\":" << r.nodes
+         << ",\"nonzeros\":" << r.nonzeros << ",\"estimated_bytes\":" << r.bytes << ",\"initial_cost\":" << r.initial_cost
+         << ",\"cost\":" << r.cost << ",\"load_seconds\":" << r.load_seconds << ",\"solve_seconds\":" << r.solve_seconds
+         << ",\"write_seconds\":" << r.write_seconds << "}\n";
+
+    return line.str();
+}
+
+// Solves G, the graph of job, with solver(G, identity) and writes the sequence.
+template<typename R, typename Z, typename Solver>
+Batch_Result solve_job(const Batch_Job & job, const Graph<R, Z> & G, Solver & solver) {
+    const Z n = numnodes(G);
+
+    std::vector<Z> identity(n);
+
+    std::iota(identity.begin(), identity.end(), 0);
+
+    Batch_Result r;
+
+    r.input = job.input; r.output = job.output;
+
+    r.nodes = n; r.nonzeros = nnz(G); r.bytes = job.bytes;
+
+    r.initial_cost = la(G);
+
+    double t = omp_get_wtime();
+
+    const std::vector<Z> sequence = solver(G, identity);
+
+    r.solve_seconds = omp_get_wtime() - t;
+
+    r.cost = la(Arrangement<R, Z>(G, sequence));
+
+    t = omp_get_wtime();
+
+    write_mtx_sequence(job.output, r.cost, sequence);
+
+    r.write_seconds = omp_get_wtime() - t;
+
+    return r;
+}
+
+// Solves every job with solver(G, identity), which returns a sequence of G,
+// and writes it to the job's output. Workers run concurrently, each solving
+// one graph while the next one it took (if the memory budget allows) is
+// already being loaded on a helper thread; nested OpenMP regions of the
+// solver run on the worker's thread, and the loader gets an equal share of
+// the threads. Results are returned in job order and the manifest lines
+// written as graphs finish. A graph that fails to load is recorded with its
+// error and the batch goes on.
+template<typename R, typename Z, typename Solver>
+std::vector<Batch_Result> solve_batch(const std::vector<Batch_Job> & jobs, Solver solver, const Batch_Options & options = Batch_Options{}) {
+    std::vector<Batch_Result> results(jobs.size());
+
+    Batch_Queue queue(jobs, options.memory_budget);
+
+    std::ofstream manifest;
+
+    if (!options.manifest.empty()) {
+        manifest.open(options.manifest);
+
+        if (!manifest.is_open()) {
+            std::cerr << "unable to open file for output : " << options.manifest << '\n';
+
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::mutex manifest_mutex;
+
+    const int workers = options.workers > 0 ? options.workers : omp_get_max_threads();
+
+    const int load_threads = std::max(1, omp_get_max_threads() / workers);
+
+    struct Loaded final {
+        Graph<R, Z> G;
+
+        double seconds;
+
+        std::string error;
+    };
+
+    const auto load = [&jobs, load_threads] (const long long k) {
+                          return std::async(std::launch::async, [&jobs, load_threads, k] {
+                                                                    omp_set_num_threads(load_threads);
+
+                                                                    const double start = omp_get_wtime();
+
+                                                                    Loaded loaded{Graph<R, Z>(std::vector<Z>{}, std::vector<Z>(1, 0), 0, 0), .0, ""};
+
+                                                                    if (read_mtx(jobs[k].input, jobs[k].pattern, loaded.G, loaded.error)) {
+                                                                        note("matrix loaded to memory\n");
+                                                                    }
+
+                                                                    loaded.seconds = omp_get_wtime() - start;
+
+                                                                    return loaded;
+                                                                });
+                      };
+
+#   pragma omp parallel num_threads(workers)
+    {
+        long long current = queue.acquire(true);
+
+        std::future<Loaded> loading;
+
+        if (current > - 1) {
+            loading = load(current);
+        }
+
+        while (current > - 1) {
+            Loaded loaded = loading.get();
+
+            const long long next = queue.acquire(false);
+
+            if (next > - 1) {
+                loading = load(next);
+            }
+
+            if (loaded.error.empty()) {
+                results[current] = solve_job<R, Z>(jobs[current], loaded.G, solver);
+
+                results[current].load_seconds = loaded.seconds;
+            }
+            else {
+                results[current].input = jobs[current].input; results[current].output = jobs[current].output;
+
+                results[current].error = loaded.error;
+            }
+
+            if (manifest.is_open()) {
+                std::lock_guard<std::mutex> lock(manifest_mutex);
+
+                manifest << manifest_line(results[current]) << std::flush;
+            }
+
+            loaded.G = Graph<R, Z>(std::vector<Z>{}, std::vector<Z>(1, 0), 0, 0);
+
+            queue.release(current);
+
+            current = next;
+
+            if (current < 0 && (current = queue.acquire(true)) > - 1) {
+                loading = load(current);
+            }
+        }
+    }
+
+    return results;
+}
+
+}
+
+#endif
@@ -0,0 +1,360 @@
+// "branch_and_bound.hh" -- implements template function branch_and_bound as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef BRANCH_AND_BOUND_HH
+#define BRANCH_AND_BOUND_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "anytime_search.hh"
+#include "or_opt.hh"
+#include "portfolio.hh"
+#include "successive_augmentation.hh"
+#include <cstdint>
+
+namespace lat {
+
+// Lossy table of the cheapest prefix cost seen per set of placed nodes,
+// shared by the threads behind striped locks. A colliding set overwrites the
+// entry, which only loses pruning.
+template<typename R>
+class Prefix_Table final {
+public:
+    Prefix_Table(const int log_size = 20) :
+    mask{(std::size_t(1) << log_size) - 1}, keys(mask + 1, 0), costs(mask + 1), locks(1024) {
+        for (omp_lock_t & lock : locks) {
+            omp_init_lock(&lock);
+        }
+    }
+
+    Prefix_Table(const Prefix_Table &) = delete;
+
+    Prefix_Table & operator=(const Prefix_Table &) = delete;
+
+    // Records cost for set and returns true, or returns false if set was
+    // reached before at no higher cost (the caller may then prune).
+    bool improve(const std::uint64_t set, const R cost) {
+        const std::size_t slot = (set * 0x9E3779B97F4A7C15ULL) >> 20 & mask;
+
+        omp_lock_t & lock = locks[slot % locks.size()];
+
+        omp_set_lock(&lock);
+
+        const bool better = keys[slot] != set || cost < costs[slot];
+
+        if (better) {
+            keys[slot] = set; costs[slot] = cost;
+        }
+
+        omp_unset_lock(&lock);
+
+        return better;
+    }
+
+    ~Prefix_Table() {
+        for (omp_lock_t & lock : locks) {
+            omp_destroy_lock(&lock);
+        }
+    }
+
+private:
+    const std::size_t mask;
+
+    std::vector<std::uint64_t> keys;
+
+    std::vector<R> costs;
+
+    std::vector<omp_lock_t> locks;
+};
+
+// Exact search of the node sequences built from the left. With the set P of
+// the first k nodes fixed, the cut of every boundary up to k is known, so a
+// prefix costs the sum of those cuts, g; the cuts after k depend only on the
+// set, so of two prefixes of the same set only the cheaper one is expanded
+// (Prefix_Table). The rest of the cost is bounded from below by
+//
+//     the edges from P to the unplaced nodes U, which cross at least
+//     0, 1, 2, ... further boundaries, the heaviest ones fewest, plus
+//
+//     the larger of half the sum over u in U of its edges into U, sorted by
+//     decreasing weight, times 1, 1, 2, 2, 3, 3, ... (two neighbours per
+//     distance) and the edges within U, sorted by decreasing weight, times
+//     |U| - 1 ones, |U| - 2 twos, ... (the pairs of positions per distance),
+//
+// and a subtree is pruned once g plus the bound reaches the incumbent. A
+// sequence and its reverse cost the same, so node anchor is kept in the
+// left half. The tree is split into OpenMP tasks down to split levels, which
+// idle threads take over, and searched depth first below.
+template<typename R, typename Z>
+class Branch_And_Bound final {
+public:
+    template<typename V, typename O>
+    Branch_And_Bound(const Graph<R, Z, V, O> & G, Incumbent<R, Z> & _incumbent, const Budget & _budget) :
+    n{numnodes(G)}, W(static_cast<std::size_t>(n) * n, .0), neighbours(n), degree(n, .0), anchor{0},
+    incumbent{_incumbent}, budget{_budget}, stop{false}, expanded{0} {
+        const Graph<R, Z, V, O> S = symmetrize(G);
+
+        const auto & A = values(S);
+
+        const Array<Z> & IA = row_indices(S);
+
+        const Array<O> & JA = col_ptrs(S);
+
+        for (Z v = 0; v < n; v++) {
+            for (O k = JA[v]; k < JA[v + 1]; k++) {
+                W[static_cast<std::size_t>(v) * n + IA[k]] += A[k];
+            }
+        }
+
+        for (Z v = 0; v < n; v++) {
+            for (Z u = 0; u < n; u++) {
+                const R w = W[static_cast<std::size_t>(v) * n + u];
+
+                if (w < 0) {
+                    std::cerr << "branch_and_bound needs non-negative weights\n";
+
+                    std::exit(EXIT_FAILURE);
+                }
+
+                if (w != 0) {
+                    neighbours[v].emplace_back(u, w); degree[v] += w;
+                }
+            }
+
+            std::sort(neighbours[v].begin(), neighbours[v].end(), [] (const auto & a, const auto & b) { return a.second > b.second; });
+
+            if (degree[v] > degree[anchor]) {
+                anchor = v;
+            }
+        }
+
+        split = 1;
+
+        for (double tasks = n; split < n - 2 && tasks < 64. * omp_get_max_threads(); split++) {
+            tasks *= n - split;
+        }
+    }
+
+    // Searches the whole tree; returns false if budget stopped it first.
+    bool solve() {
+#       pragma omp parallel
+#       pragma omp single
+        expand(std::vector<Z>{}, 0, .0, .0);
+
+        return !stop.load();
+    }
+
+    unsigned long long nodes() const { return expanded.load(); }
+
+    ~Branch_And_Bound() { ; }
+
+private:
+    bool placed(const std::uint64_t set, const Z v) const { return set >> v & 1; }
+
+    R bound(const std::uint64_t set, std::vector<R> & to_placed, std::vector<R> & inner, std::vector<R> & edges) const {
+        to_placed.clear(); edges.clear();
+
+        R total = .0, by_degree = .0, by_edges = .0;
+
+        for (Z u = 0; u < n; u++) {
+            if (placed(set, u)) {
+                continue;
+            }
+
+            R w = .0;
+
+            inner.clear();
+
+            for (const auto & [v, weight] : neighbours[u]) {
+                if (placed(set, v)) {
+                    w += weight;
+                }
+                else {
+                    inner.push_back(weight);
+
+                    if (u < v) {
+                        edges.push_back(weight);
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < inner.size(); i++) {
+                by_degree += inner[i] * static_cast<R>(i / 2 + 1) / 2;
+            }
+
+            to_placed.push_back(w);
+        }
+
+        std::sort(to_placed.begin(), to_placed.end(), std::greater<R>());
+
+        for (std::size_t i = 0; i < to_placed.size(); i++) {
+            total += to_placed[i] * static_cast<R>(i);
+        }
+
+        std::sort(edges.begin(), edges.end(), std::greater<R>());
+
+        const std::size_t m = to_placed.size();
+
+        for (std::size_t i = 0, d = 1, left = m - 1; i < edges.size(); i++, left--) {
+            if (left == 0) {
+                d++; left = m - d;
+            }
+
+            by_edges += edges[i] * static_cast<R>(d);
+        }
+
+        return total + std::max(by_degree, by_edges);
+    }
+
+    // prefix holds the placed nodes in order, set the same as a bit set, g
+    // the cost of their boundaries and cut the weight between set and the rest.
+    void expand(std::vector<Z> prefix, const std::uint64_t set, const R g, const R cut) {
+        if (stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const Z k = prefix.size();
+
+        if (k == n) {
+            incumbent.offer(g, prefix);
+
+            return;
+        }
+
+        if ((expanded.fetch_add(1, std::memory_order_relaxed) & 1023) == 0
+            && (budget.exhausted(clock, 0) || budget.reached(incumbent.best().cost))) {
+            stop.store(true, std::memory_order_relaxed);
+
+            return;
+        }
+
+        if (k == (n - 1) / 2 + 1 && !placed(set, anchor)) {
+            return;
+        }
+
+        if (k > 1 && k < n - 1 && !table.improve(set, g)) {
+            return;
+        }
+
+        std::vector<R> to_placed, inner, edges;
+
+        if (!(g + bound(set, to_placed, inner, edges) < incumbent.best().cost)) {
+            return;
+        }
+
+        std::vector<std::pair<R, Z>> children;
+
+        for (Z v = 0; v < n; v++) {
+            if (!placed(set, v)) {
+                R w = .0;
+
+                for (const auto & [u, weight] : neighbours[v]) {
+                    if (placed(set, u)) {
+                        w += weight;
+                    }
+                }
+
+                children.emplace_back(cut + degree[v] - 2 * w, v);
+            }
+        }
+
+        std::sort(children.begin(), children.end());
+
+        prefix.push_back(0);
+
+        for (const auto & [child_cut, v] : children) {
+            prefix.back() = v;
+
+            const std::uint64_t child_set = set | std::uint64_t(1) << v;
+
+            const R child_g = g + child_cut;
+
+            if (k < split) {
+#               pragma omp task firstprivate(prefix, child_set, child_g, child_cut)
+                expand(prefix, child_set, child_g, child_cut);
+            }
+            else {
+                expand(prefix, child_set, child_g, child_cut);
+            }
+        }
+    }
+
+    const Z n;
+
+    std::vector<R> W;
+
+    std::vector<std::vector<std::pair<Z, R>>> neighbours;
+
+    std::vector<R> degree;
+
+    Z anchor, split;
+
+    Incumbent<R, Z> & incumbent;
+
+    const Budget & budget;
+
+    Stopwatch clock;
+
+    Prefix_Table<R> table;
+
+    std::atomic<bool> stop;
+
+    std::atomic<unsigned long long> expanded;
+};
+
+// Optimal sequence of G, n <= 64, for non-negative weights. The tree grows
+// exponentially: sparse graphs of about 24 nodes take seconds on one core,
+// and each further node multiplies that, so budget bounds larger runs. The
+// incumbent starts from successive_augmentation refined by Or-opt. cost
+// receives the cost of the sequence returned and optimal whether it is proven
+// optimal, which is false only if budget stopped the search (by time,
+// cancellation or because the incumbent reached its target gap).
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> branch_and_bound(const Graph<R, Z, W, O> & G, R & cost, bool & optimal, const Budget & budget = Budget{}) {
+    const Z n = numnodes(G);
+
+    if (n > 64) {
+        std::cerr << "branch_and_bound is limited to 64 nodes, got " << n << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<Z> sequence(n);
+
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    if (n > 1) {
+        sequence = or_opt(G, successive_augmentation(G, sequence));
+    }
+
+    Incumbent<R, Z> incumbent(la(Arrangement<R, Z, W, O>(G, sequence)), sequence);
+
+    optimal = n < 3 || Branch_And_Bound<R, Z>(G, incumbent, budget).solve();
+
+    const auto & best = incumbent.best();
+
+    cost = la(Arrangement<R, Z, W, O>(G, best.sequence));
+
+    return best.sequence;
+}
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+// "budget.hh" -- implements the search limits Budget and Cancellation_Token as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef BUDGET_HH
+#define BUDGET_HH
+
+#include "telemetry.hh"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace lat {
+
+// Cooperative cancellation: cancel() may be called from any thread (or a
+// signal handler, the flag being lock-free) and the search stops within one
+// row of the swap scan.
+class Cancellation_Token final {
+public:
+    void cancel() { flag.store(true, std::memory_order_relaxed); }
+
+    bool cancelled() const { return flag.load(std::memory_order_relaxed); }
+
+    void reset() { flag.store(false, std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> flag{false};
+};
+
+// Limits of an anytime search; zero seconds or evaluations mean no limit.
+// Evaluations are scored swaps. The search also stops once its cost is within
+// gap (relative) of lower_bound, e.g. from lower_bound() in lower_bounds.hh.
+// With a checkpoint file name the current sequence is written there in the
+// write_mtx_sequence format every checkpoint_seconds and when the search ends.
+struct Budget final {
+    double seconds = 0;
+
+    unsigned long long evaluations = 0;
+
+    double lower_bound = - std::numeric_limits<double>::infinity(), gap = 0;
+
+    const Cancellation_Token * token = nullptr;
+
+    std::string checkpoint;
+
+    double checkpoint_seconds = 60;
+
+    bool exhausted(const Stopwatch & clock, const unsigned long long evaluated) const {
+        return (token && token->cancelled()) || (evaluations > 0 && evaluated >= evaluations)
+               || (seconds > 0 && clock.elapsed() >= seconds);
+    }
+
+    bool reached(const double cost) const {
+        if (!std::isfinite(lower_bound)) {
+            return false;
+        }
+
+        return cost <= lower_bound + gap * std::abs(lower_bound);
+    }
+
+    // What is left of this budget after the time on clock, for a step of a
+    // search that checks its own stopwatch: the same token and target, the
+    // seconds still left, and no evaluation limit or checkpoint.
+    Budget remaining(const Stopwatch & clock) const {
+        Budget rest;
+
+        rest.lower_bound = lower_bound; rest.gap = gap; rest.token = token;
+
+        if (seconds > 0) {
+            rest.seconds = std::max(seconds - clock.elapsed(), std::numeric_limits<double>::min());
+        }
+
+        return rest;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+// "components.hh" -- implements template functions connected_components and solve_components as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef COMPONENTS_HH
+#define COMPONENTS_HH
+
+#include "Graph.hh"
+#include <atomic>
+
+namespace lat {
+
+// Root of v in the concurrent union-find forest parent, halving paths as it goes.
+template<typename Z>
+Z find_root(std::vector<std::atomic<Z>> & parent, Z v) {
+    while (true) {
+        Z p = parent[v].load(std::memory_order_relaxed);
+
+        const Z g = parent[p].load(std::memory_order_relaxed);
+
+        if (p == g) {
+            return p;
+        }
+
+        parent[v].compare_exchange_weak(p, g, std::memory_order_relaxed);
+
+        v = g;
+    }
+}
+
+// Labels the connected components of the undirected graph behind G (edge
+// directions are ignored). Edges are merged in parallel into a lock-free
+// union-find that always hangs the larger root under the smaller, so every
+// root ends up the least node of its component. component[v] receives the
+// component of v, numbered in order of their least node; returns how many
+// there are.
+template<typename R, typename Z, typename W, typename O>
+Z connected_components(const Graph<R, Z, W, O> & G, std::vector<Z> & component) {
+    const Array<Z> & IA = row_indices(G);
+
+    const Array<O> & JA = col_ptrs(G);
+
+    const Z n = numnodes(G);
+
+    std::vector<std::atomic<Z>> parent(n);
+
+#   pragma omp parallel for
+    for (Z v = 0; v < n; v++) {
+        parent[v].store(v, std::memory_order_relaxed);
+    }
+
+#   pragma omp parallel for schedule(guided)
+    for (Z v = 0; v < n; v++) {
+        for (O k = JA[v]; k < JA[v + 1]; k++) {
+            Z a = find_root(parent, v), b = find_root(parent, IA[k]);
+
+            while (a != b) {
+                if (a < b) {
+                    std::swap(a, b);
+                }
+
+                Z expected = a;
+
+                if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+                    break;
+                }
+
+                a = find_root(parent, a); b = find_root(parent, b);
+            }
+        }
+    }
+
+    std::vector<Z> label(n, - 1);
+
+    Z count = 0;
+
+    for (Z v = 0; v < n; v++) {
+        if (parent[v].load(std::memory_order_relaxed) == v) {
+            label[v] = count++;
+        }
+    }
+
+    component.assign(n, - 1);
+
+#   pragma omp parallel for
+    for (Z v = 0; v < n; v++) {
+        component[v] = label[find_root(parent, v)];
+    }
+
+    return count;
+}
+
+// Splits G into its connected components, taken in the order of their first
+// node in sequence. members[c] lists the nodes of component c in sequence
+// order, and parts[c] is the subgraph they induce, node i standing for
+// members[c][i]. The parts are extracted in parallel in O(n + nnz) overall.
+template<typename R, typename Z, typename W, typename O>
+void split_components(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence,
+                      std::vector<Graph<R, Z, W, O>> & parts, std::vector<std::vector<Z>> & members) {
+    const auto & A = values(G);
+
+    const Array<Z> & IA = row_indices(G);
+
+    const Array<O> & JA = col_ptrs(G);
+
+    std::vector<Z> component, rank, local(numnodes(G));
+
+    const Z count = connected_components(G, component);
+
+    rank.assign(count, - 1);
+
+    members.assign(count, std::vector<Z>{});
+
+    Z ranked = 0;
+
+    for (const Z v : sequence) {
+        Z & c = rank[component[v]];
+
+        if (c < 0) {
+            c = ranked++;
+        }
+
+        local[v] = members[c].size();
+
+        members[c].push_back(v);
+    }
+
+    std::vector<Graph<R, Z, W, O>> extracted(count, Graph<R, Z, W, O>(std::vector<Z>{}, std::vector<O>(1, 0), 0, 0));
+
+#   pragma omp parallel for schedule(dynamic)
+    for (Z c = 0; c < count; c++) {
+        const Z m = members[c].size();
+
+        std::vector<Z> resIA;
+
+        std::vector<O> resJA(m + 1, 0);
+
+        std::vector<R> resA;
+
+        for (Z i = 0; i < m; i++) {
+            const Z v = members[c][i];
+
+            for (O k = JA[v]; k < JA[v + 1]; k++) {
+                resIA.push_back(local[IA[k]]);
+
+                if constexpr (W::stored) {
+                    resA.push_back(A[k]);
+                }
+            }
+
+            resJA[i + 1] = resIA.size();
+        }
+
+        extracted[c] = Graph<R, Z, W, O>(std::move(resA), std::move(resIA), std::move(resJA), m, m, half_stored(G));
+    }
+
+    parts = std::move(extracted);
+}
+
+// Solves every connected component of G on its own and concatenates the
+// results, components in the order of split_components(). solver
+// is called as solver(C, initial) with C a component and initial its nodes
+// in sequence order (the identity of C), and returns a sequence of C.
+// Components are solved concurrently as tasks, largest first; components of
+// up to two nodes need no solving. cost receives la of the result, the sum
+// of the component costs since no edge joins two components.
+template<typename R, typename Z, typename W, typename O, typename Solver>
+std::vector<Z> solve_components(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, Solver solver, R & cost) {
+    std::vector<Graph<R, Z, W, O>> parts;
+
+    std::vector<std::vector<Z>> members;
+
+    split_components(G, sequence, parts, members);
+
+    const Z count = parts.size();
+
+    std::vector<Z> order(count);
+
+    std::iota(order.begin(), order.end(), 0);
+
+    std::stable_sort(order.begin(), order.end(), [&members] (const Z a, const Z b) {
+                                                     return members[a].size() > members[b].size();
+                                                 });
+
+    std::vector<std::vector<Z>> solved(count);
+
+    std::vector<R> costs(count, .0);
+
+#   pragma omp parallel
+#   pragma omp single
+    for (const Z c : order) {
+#       pragma omp task firstprivate(c)
+        {
+            const Z m = members[c].size();
+
+            std::vector<Z> local(m);
+
+            std::iota(local.begin(), local.end(), 0);
+
+            if (m > 2) {
+                local = solver(parts[c], local);
+            }
+
+            costs[c] = la(parts[c](local));
+
+            solved[c].resize(m);
+
+            for (Z i = 0; i < m; i++) {
+                solved[c][i] = members[c][local[i]];
+            }
+        }
+    }
+
+    std::vector<Z> result;
+
+    result.reserve(sequence.size());
+
+    cost = .0;
+
+    for (Z c = 0; c < count; c++) {
+        result.insert(result.end(), solved[c].begin(), solved[c].end());
+
+        cost += costs[c];
+    }
+
+    return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+// "cuthill_mckee.hh" -- implements template functions cuthill_mckee, reverse_cuthill_mckee and bfs_sequence as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef CUTHILL_MCKEE_HH
+#define CUTHILL_MCKEE_HH
+
+#include "Graph.hh"
+#include <tuple>
+
+namespace lat {
+
+// Level-synchronous BFS of the undirected adjacency S from root, appending the
+// nodes reached to order and marking them with stamp. Within a level nodes
+// follow the order of their first parent in the previous level and, when
+// by_degree, increasing degree and then index, as in Cuthill-McKee. Large
+// frontiers are expanded in parallel into per-thread buffers that are merged
+// in frontier order, so the result does not depend on the number of threads.
+// Returns the number of levels; last_level is the index in order where the
+// deepest level starts.
+template<typename R, typename Z, typename W, typename O>
+Z level_order(const Graph<R, Z, W, O> & S, const Z root, const Z stamp, std::vector<Z> & mark, std::vector<Z> & order,
+              const bool by_degree, Z & last_level) {
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const auto fewer_neighbours = [&JA] (const Z a, const Z b) {
+                                      return std::make_tuple(JA[a + 1] - JA[a], a) < std::make_tuple(JA[b + 1] - JA[b], b);
+                                  };
+
+    const auto expand = [&] (const Z v, std::vector<Z> & buffer) {
+                            const std::size_t start = buffer.size();
+
+                            for (O k = JA[v]; k < JA[v + 1]; k++) {
+                                if (mark[IA[k]] != stamp) {
+                                    buffer.push_back(IA[k]);
+                                }
+                            }
+
+                            if (by_degree) {
+                                std::sort(buffer.begin() + start, buffer.end(), fewer_neighbours);
+                            }
+                        };
+
+    std::vector<std::vector<Z>> buffers(1);
+
+    Z first = order.size(), levels = 0;
+
+    mark[root] = stamp;
+
+    order.push_back(root);
+
+    while (first < static_cast<Z>(order.size())) {
+        const Z last = order.size();
+
+        last_level = first; levels++;
+
+        if (last - first < 1024) {
+            buffers.resize(1); buffers[0].clear();
+
+            for (Z f = first; f < last; f++) {
+                expand(order[f], buffers[0]);
+            }
+        }
+        else {
+            buffers.resize(omp_get_max_threads());
+
+#           pragma omp parallel num_threads(buffers.size())
+            {
+                std::vector<Z> & buffer = buffers[omp_get_thread_num()];
+
+                buffer.clear();
+
+#               pragma omp for schedule(static)
+                for (Z f = first; f < last; f++) {
+                    expand(order[f], buffer);
+                }
+            }
+        }
+
+        for (const auto & buffer : buffers) {
+            for (const Z u : buffer) {
+                if (mark[u] != stamp) {
+                    mark[u] = stamp;
+
+                    order.push_back(u);
+                }
+            }
+        }
+
+        first = last;
+    }
+
+    return levels;
+}
+
+// George-Liu search for a pseudo-peripheral node of the component of root:
+// restarts the BFS from a node of least degree in the deepest level for as
+// long as the eccentricity grows.
+template<typename R, typename Z, typename W, typename O>
+Z pseudo_peripheral_node(const Graph<R, Z, W, O> & S, Z root, Z & stamp, std::vector<Z> & mark) {
+    const Array<O> & JA = col_ptrs(S);
+
+    std::vector<Z> order;
+
+    Z last_level, eccentricity = level_order(S, root, ++stamp, mark, order, false, last_level);
+
+    while (true) {
+        const Z candidate = * std::min_element(order.begin() + last_level, order.end(), [&JA] (const Z a, const Z b) {
+                                                                                             return JA[a + 1] - JA[a] < JA[b + 1] - JA[b];
+                                                                                         });
+
+        order.clear();
+
+        const Z e = level_order(S, candidate, ++stamp, mark, order, false, last_level);
+
+        if (e <= eccentricity) {
+            return root;
+        }
+
+        root = candidate; eccentricity = e;
+    }
+}
+
+// BFS ordering of every connected component of G from a pseudo-peripheral
+// node, components taken in the order of their least-degree node. With
+// by_degree this is the Cuthill-McKee ordering.
+template<typename R, typename Z, typename W, typename O>
+const std::vector<Z> level_sequence(const Graph<R, Z, W, O> & G, const bool by_degree) {
+    const Graph<R, Z, W, O> S = symmetrize(G);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z n = numnodes(S);
+
+    std::vector<Z> starts(n), mark(n, - 1), sequence;
+
+    std::iota(starts.begin(), starts.end(), 0);
+
+    std::stable_sort(starts.begin(), starts.end(), [&JA] (const Z a, const Z b) {
+                                                       return JA[a + 1] - JA[a] < JA[b + 1] - JA[b];
+                                                   });
+
+    sequence.reserve(n);
+
+    std::vector<char> placed(n, false);
+
+    Z stamp = 0, last_level;
+
+    for (const Z start : starts) {
+        if (placed[start]) {
+            continue;
+        }
+
+        const Z root = pseudo_peripheral_node(S, start, stamp, mark);
+
+        const Z first = sequence.size();
+
+        level_order(S, root, ++stamp, mark, sequence, by_degree, last_level);
+
+        for (Z i = first; i < static_cast<Z>(sequence.size()); i++) {
+            placed[sequence[i]] = true;
+        }
+    }
+
+    return sequence;
+}
+
+template<typename R, typename Z, typename W, typename O>
+const std::vector<Z> bfs_sequence(const Graph<R, Z, W, O> & G) {
+    return level_sequence(G, false);
+}
+
+template<typename R, typename Z, typename W, typename O>
+const std::vector<Z> cuthill_mckee(const Graph<R, Z, W, O> & G) {
+    return level_sequence(G, true);
+}
+
+template<typename R, typename Z, typename W, typename O>
+const std::vector<Z> reverse_cuthill_mckee(const Graph<R, Z, W, O> & G) {
+    std::vector<Z> sequence = level_sequence(G, true);
+
+    std::reverse(sequence.begin(), sequence.end());
+
+    return sequence;
+}
+
+}
+
+#endif
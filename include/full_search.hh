@@ -22,61 +22,108 @@
 #define FULL_SEARCH_HH
 
 #include "Graph.hh"
+#include "Arrangement.hh"
+#include "telemetry.hh"
+#include "budget.hh"
 
 namespace lat {
-    
-template<typename R, typename Z>
-std::vector<Z> full_search(const Graph<R, Z> & G, std::vector<Z> sequence) {
-    R min_cost = la(G(sequence));
 
-    Z z =0, cnt = 0;
+// Applies the best improving swap of the 2-swap neighbourhood of sequence and
+// returns its cost change (.0 if sequence is already a local minimum).
+template<typename R, typename Z, typename W, typename O>
+const R select_best_swap(const Graph<R, Z, W, O> & S, Arrangement<R, Z, W, O> & P) {
+    const Z n = numnodes(S);
 
-    while (z < 1) {
-        z++;
-
-        std::cout << cnt << ' '  << min_cost << '\n';
+    R min_delta = .0;
 
-        select_best_neighbor(G, sequence);
+    Z ii = 0, jj = 0;
 
-        R new_cost = la(G(sequence));
+    for (Z i = 0; i < n - 1; i++) {
+        for (Z j = i + 1; j < n; j++) {
+            const R delta = swap_delta(S, P, i, j);
 
-        if (new_cost < min_cost) {
-            cnt++;
-
-            z = 0;
+            if (delta < min_delta) {
+                min_delta = delta;
 
-            min_cost = new_cost;
+                ii = i; jj = j;
+            }
         }
     }
 
-    return sequence;
+    P.swap(ii, jj);
+
+    return min_delta;
 }
 
-template<typename R, typename Z>
-void select_best_neighbor(const Graph<R, Z> & G, std::vector<Z> & sequence) {
-    Z n = numnodes(G);
+// Steepest descent over the 2-swap neighbourhood from sequence until no swap
+// improves. observer (see telemetry.hh) is told of every step; pass
+// Text_Observer{} for the old "iteration cost" lines on std::cout. budget is
+// checked after every swap applied, so the search also stops once its time or
+// evaluations run out, its token is cancelled or the cost is within the target
+// gap; the checkpoint is not used.
+template<typename R, typename Z, typename W, typename O, typename Observer = Null_Observer>
+std::vector<Z> full_search(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, Observer && observer = Observer{},
+                           const Budget & budget = Budget{}) {
+    Stopwatch clock;
 
-    R min_cost = la(G(sequence));
+    const Graph<R, Z, W, O> S = symmetrize(G);
 
-    Z ii =0, jj = 0;
+    Arrangement<R, Z, W, O> P(G, sequence);
 
-    for (auto i = 0; i < n - 1; i++) {
-        for (auto j = i + 1; j < n; j++) {
-            std::swap(sequence[i], sequence[j]);
+    observer.on_phase("symmetrize", clock.split());
 
-            R new_cost = la(G(sequence));
+    const Z n = numnodes(G);
 
-            if (new_cost < min_cost) {
-                min_cost = new_cost;
+    const unsigned long long scan = n > 1 ? static_cast<unsigned long long>(n) * (n - 1) / 2 : 0;
 
-                ii = i; jj = j;
-            }
-            
-            std::swap(sequence[i], sequence[j]);
+    Progress progress;
+
+    progress.cost = la(P);
+
+    bool stop = budget.exhausted(clock, 0) || budget.reached(progress.cost);
+
+    Z z = 0;
+
+    while (z < 1 && !stop) {
+        z++;
+
+        clock.stamp(progress);
+
+        observer.on_iteration(progress);
+
+        const R delta = select_best_swap(S, P);
+
+        progress.moves_evaluated += scan;
+
+        if (delta < 0) {
+            progress.iteration++;
+
+            z = 0;
+
+            progress.cost += delta;
+
+            stop = budget.exhausted(clock, progress.moves_evaluated) || budget.reached(progress.cost);
         }
     }
 
-    std::swap(sequence[ii], sequence[jj]);
+    observer.on_phase("search", clock.split());
+
+    observer.on_thread_work(0, progress.moves_evaluated);
+
+    clock.stamp(progress);
+
+    observer.on_finish(progress);
+
+    return P.sequence();
+}
+
+template<typename R, typename Z, typename W, typename O>
+void select_best_neighbor(const Graph<R, Z, W, O> & G, std::vector<Z> & sequence) {
+    Arrangement<R, Z, W, O> P(G, sequence);
+
+    select_best_swap(symmetrize(G), P);
+
+    sequence = P.sequence();
 }
 
 }
@@ -0,0 +1,249 @@
+// "island.hh" -- implements template function island_search as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Needs MPI: compile with mpicxx and run with mpirun.
+
+#ifndef ISLAND_HH
+#define ISLAND_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "portfolio.hh"
+#include <mpi.h>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace lat {
+
+template<typename T>
+MPI_Datatype mpi_type() {
+    if constexpr (std::is_same_v<T, double>) {
+        return MPI_DOUBLE;
+    }
+    else if constexpr (std::is_same_v<T, float>) {
+        return MPI_FLOAT;
+    }
+    else if constexpr (std::is_same_v<T, int>) {
+        return MPI_INT;
+    }
+    else if constexpr (std::is_same_v<T, long>) {
+        return MPI_LONG;
+    }
+    else if constexpr (std::is_same_v<T, long long>) {
+        return MPI_LONG_LONG;
+    }
+    else if constexpr (std::is_same_v<T, unsigned>) {
+        return MPI_UNSIGNED;
+    }
+    else {
+        static_assert(std::is_same_v<T, unsigned long long>, "no MPI datatype for this type");
+
+        return MPI_UNSIGNED_LONG_LONG;
+    }
+}
+
+// MPI_Bcast of count elements at data from rank root, in pieces of at most
+// INT_MAX elements, as MPI counts are ints.
+template<typename T>
+void broadcast(T * data, const long long count, const int root, MPI_Comm comm) {
+    const long long piece = std::numeric_limits<int>::max();
+
+    for (long long first = 0; first < count; first += piece) {
+        MPI_Bcast(data + first, static_cast<int>(std::min(piece, count - first)), mpi_type<T>(), root, comm);
+    }
+}
+
+// Sends G from rank root to every rank of comm; the other ranks pass any
+// graph (e.g. an empty one) and receive their copy. Every rank aborts comm
+// if the sizes do not fit its Z and O.
+template<typename R, typename Z, typename W, typename O>
+Graph<R, Z, W, O> broadcast_graph(const Graph<R, Z, W, O> & G, const int root, MPI_Comm comm) {
+    int rank;
+
+    MPI_Comm_rank(comm, &rank);
+
+    long long size[4] = {numrows(G), numnodes(G), static_cast<long long>(nnz(G)), half_stored(G)};
+
+    MPI_Bcast(size, 4, MPI_LONG_LONG, root, comm);
+
+    if (size[0] > std::numeric_limits<Z>::max() || size[1] >= std::numeric_limits<Z>::max()
+        || static_cast<unsigned long long>(size[2]) > static_cast<unsigned long long>(std::numeric_limits<O>::max())) {
+        std::cerr << "rank " << rank << ": a graph of " << size[1] << " nodes and " << size[2] << " entries does not fit its index types\n";
+
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+
+    std::vector<R> A(W::stored ? size[2] : 0);
+
+    std::vector<Z> IA(size[2]);
+
+    std::vector<O> JA(size[1] + 1);
+
+    if (rank == root) {
+        if constexpr (W::stored) {
+            std::copy(values(G).begin(), values(G).end(), A.begin());
+        }
+
+        std::copy(row_indices(G).begin(), row_indices(G).end(), IA.begin());
+
+        std::copy(col_ptrs(G).begin(), col_ptrs(G).end(), JA.begin());
+    }
+
+    broadcast(A.data(), A.size(), root, comm);
+
+    broadcast(IA.data(), size[2], root, comm);
+
+    broadcast(JA.data(), size[1] + 1, root, comm);
+
+    return Graph<R, Z, W, O>(std::move(A), std::move(IA), std::move(JA), size[0], size[1], size[3] != 0);
+}
+
+// rounds is the number of local search rounds between migrations and epochs
+// the number of migrations; budget (seconds, cancellation or target gap) may
+// end the search sooner, all ranks stopping at the same epoch. The strategies
+// get the time left, so a long round ends with the budget too.
+struct Island_Options final {
+    int epochs = 16, rounds = 1;
+
+    Budget budget;
+
+    unsigned long long seed = 2019;
+};
+
+// What island_search did, identical on every rank. rounds_per_second is the
+// throughput of all ranks together, the figure to compare across -np.
+struct Island_Report final {
+    int ranks = 0, epochs = 0;
+
+    unsigned long long rounds = 0;
+
+    double seconds = .0, rounds_per_second = .0, initial_cost = .0, cost = .0;
+
+    std::vector<double> rank_costs, rank_seconds;
+};
+
+// Island model over the ranks of comm. Every rank runs its own strategy
+// (strategies[rank % size]) with its own seeds from its own copy of
+// sequence, the ranks other than 0 starting from a perturbed copy. After
+// every epoch each rank sends its best sequence to the next rank of a ring
+// and adopts the one it receives if better, crossed over with its own half
+// of the time to keep the islands apart. At the end the best sequence of all
+// ranks is returned on every rank. G and sequence must be the same on every
+// rank (see broadcast_graph); the OpenMP threads of each rank run inside the
+// strategies.
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> island_search(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, MPI_Comm comm,
+                             const std::vector<Strategy<R, Z, W, O>> & strategies = default_strategies<R, Z, W, O>(),
+                             const Island_Options & options = Island_Options{}, Island_Report * report = nullptr) {
+    int rank, ranks;
+
+    MPI_Comm_rank(comm, &rank);
+
+    MPI_Comm_size(comm, &ranks);
+
+    const Z n = sequence.size();
+
+    const int next = (rank + 1) % ranks, previous = (rank + ranks - 1) % ranks;
+
+    std::mt19937_64 engine(options.seed + rank);
+
+    MPI_Barrier(comm);
+
+    Stopwatch clock;
+
+    const R initial_cost = la(Arrangement<R, Z, W, O>(G, sequence));
+
+    std::vector<Z> best = rank == 0 ? sequence : perturb(sequence, std::max(Z(1), n / 16), engine), from = best, received(n);
+
+    R best_cost = la(Arrangement<R, Z, W, O>(G, best));
+
+    const Strategy<R, Z, W, O> & strategy = strategies[rank % strategies.size()];
+
+    unsigned long long rounds = 0;
+
+    int epoch = 0;
+
+    for (; epoch < options.epochs; epoch++) {
+        int stop = options.budget.exhausted(clock, 0) || options.budget.reached(best_cost);
+
+        MPI_Allreduce(MPI_IN_PLACE, &stop, 1, MPI_INT, MPI_LOR, comm);
+
+        if (stop) {
+            break;
+        }
+
+        for (int r = 0; r < options.rounds; r++, rounds++) {
+            std::vector<Z> result = strategy(G, from, options.seed + rounds * ranks + rank, options.budget.remaining(clock));
+
+            const R cost = la(Arrangement<R, Z, W, O>(G, result));
+
+            if (cost < best_cost) {
+                best_cost = cost; best = std::move(result);
+            }
+
+            from = perturb(best, std::max(Z(1), n / 64), engine);
+        }
+
+        R received_cost;
+
+        MPI_Sendrecv(&best_cost, 1, mpi_type<R>(), next, 0, &received_cost, 1, mpi_type<R>(), previous, 0, comm, MPI_STATUS_IGNORE);
+
+        MPI_Sendrecv(best.data(), n, mpi_type<Z>(), next, 1, received.data(), n, mpi_type<Z>(), previous, 1, comm, MPI_STATUS_IGNORE);
+
+        if (received_cost < best_cost) {
+            from = engine() % 2 ? received : crossover(best, received, engine);
+
+            best_cost = received_cost; best.swap(received);
+        }
+    }
+
+    struct { double cost; int rank; } local{static_cast<double>(best_cost), rank}, global;
+
+    MPI_Allreduce(&local, &global, 1, MPI_DOUBLE_INT, MPI_MINLOC, comm);
+
+    MPI_Bcast(best.data(), n, mpi_type<Z>(), global.rank, comm);
+
+    if (report) {
+        const double seconds = clock.elapsed();
+
+        report->ranks = ranks; report->epochs = epoch;
+
+        report->rank_costs.resize(ranks); report->rank_seconds.resize(ranks);
+
+        MPI_Allgather(&local.cost, 1, MPI_DOUBLE, report->rank_costs.data(), 1, MPI_DOUBLE, comm);
+
+        MPI_Allgather(&seconds, 1, MPI_DOUBLE, report->rank_seconds.data(), 1, MPI_DOUBLE, comm);
+
+        MPI_Allreduce(&rounds, &report->rounds, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+
+        report->seconds = * std::max_element(report->rank_seconds.begin(), report->rank_seconds.end());
+
+        report->rounds_per_second = report->rounds / report->seconds;
+
+        report->initial_cost = initial_cost; report->cost = global.cost;
+    }
+
+    return best;
+}
+
+}
+
+#endif
@@ -0,0 +1,310 @@
+// "load_csc.hh" -- implements template functions for reading and writing binary CSC snapshots as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Snapshot layout, in native byte order :
+//
+//     Header (64 bytes) : magic "LATCSC\0\0" or "LATSEQ\0\0", version, byte
+//                         order tag 0x01020304, sizeof(integer), sizeof(real)
+//                         (0 for pattern graphs), then rows, cols, nnz as 64
+//                         bit unsigned integers (graphs) or length and cost
+//                         (sequences), then sizeof(offset) (0 if equal to
+//                         sizeof(integer)) and a byte that is 1 for half
+//                         stored graphs (version 2 on)
+//     Graph body        : JA[cols + 1], IA[nnz], A[nnz] (absent for pattern graphs)
+//     Sequence body     : s[length], 0-based
+//
+// Every array starts on a 64 byte boundary, so a mapped snapshot can be used
+// in place.
+
+#ifndef LOAD_CSC_HH
+#define LOAD_CSC_HH
+
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "Graph.hh"
+#include "mapped_file.hh"
+#include "telemetry.hh"
+
+namespace lat {
+
+// Version 2 added the half byte; version 1 snapshots are still read, as full
+// graphs.
+constexpr std::uint32_t csc_version = 2;
+
+constexpr std::uint64_t csc_alignment = 64;
+
+struct Snapshot_Header final {
+    char magic[8];
+
+    std::uint32_t version, byte_order, index_bytes, real_bytes;
+
+    std::uint64_t rows, cols, nnz;
+
+    double cost;
+
+    std::uint32_t offset_bytes;
+
+    std::uint8_t half;
+
+    char reserved[3];
+};
+
+static_assert(sizeof(Snapshot_Header) == csc_alignment, "snapshot header must fill one alignment block");
+
+inline std::uint64_t csc_align(const std::uint64_t offset) {
+    return (offset + csc_alignment - 1) / csc_alignment * csc_alignment;
+}
+
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+const Snapshot_Header make_header(const char * magic, const std::uint64_t rows, const std::uint64_t cols,
+                                  const std::uint64_t nnz, const double cost) {
+    Snapshot_Header h{};
+
+    std::memcpy(h.magic, magic, sizeof(h.magic));
+
+    h.version = csc_version; h.byte_order = 0x01020304;
+
+    h.index_bytes = sizeof(integer); h.real_bytes = weights::stored ? sizeof(real) : 0;
+
+    h.offset_bytes = sizeof(offset) == sizeof(integer) ? 0 : sizeof(offset);
+
+    h.rows = rows; h.cols = cols; h.nnz = nnz; h.cost = cost;
+
+    return h;
+}
+
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+void check_header(const Snapshot_Header & h, const char * magic, const std::string & file_name) {
+    if (std::memcmp(h.magic, magic, sizeof(h.magic)) != 0 || h.version < 1 || h.version > csc_version || h.byte_order != 0x01020304) {
+        std::cerr << "not a version 1 to " << csc_version << " snapshot for this machine : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    const Snapshot_Header expected = make_header<real, integer, weights, offset>(magic, 0, 0, 0, .0);
+
+    if (h.index_bytes != expected.index_bytes || h.real_bytes != expected.real_bytes || h.offset_bytes != expected.offset_bytes) {
+        std::cerr << "snapshot holds " << h.index_bytes << " byte indices, "
+                  << (h.offset_bytes ? h.offset_bytes : h.index_bytes) << " byte column pointers and "
+                  << h.real_bytes << " byte values : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Checks the arrays of a mapped snapshot before a Graph uses them: JA must
+// start at 0, never decrease and end at nnz, and every row index must be
+// below rows. One parallel pass, O(cols + nnz).
+template<typename integer, typename offset>
+void check_csc(const offset * JA, const integer * IA, const std::uint64_t rows, const std::uint64_t cols,
+               const std::uint64_t nnz, const std::string & file_name) {
+    const std::int64_t n = cols, m = nnz;
+
+    std::int64_t bad = JA[0] != 0 || static_cast<std::uint64_t>(JA[n]) != nnz;
+
+#   pragma omp parallel for reduction(+ : bad)
+    for (std::int64_t j = 0; j < n; j++) {
+        bad += JA[j + 1] < JA[j];
+    }
+
+#   pragma omp parallel for reduction(+ : bad)
+    for (std::int64_t k = 0; k < m; k++) {
+        bad += static_cast<std::uint64_t>(IA[k]) >= rows;
+    }
+
+    if (bad) {
+        std::cerr << "corrupt snapshot, column pointers or row indices out of range : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+template<typename T>
+void write_block(std::ofstream & file, const T * data, const std::uint64_t n) {
+    file.write(reinterpret_cast<const char *>(data), n * sizeof(T));
+
+    const std::uint64_t bytes = n * sizeof(T), padding = csc_align(bytes) - bytes;
+
+    const char zeros[csc_alignment] = {};
+
+    file.write(zeros, padding);
+}
+
+template<typename real, typename integer, typename weights, typename offset>
+void write_csc(const std::string & file_name, const Graph<real, integer, weights, offset> & G) {
+    std::ofstream file(file_name, std::ios::binary);
+
+    if (!file.is_open()) {
+        std::cerr << "unable to open file for output : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+    else {
+        note("successfully opened file ", file_name, '\n');
+    }
+
+    const Array<offset> & JA = col_ptrs(G);
+
+    Snapshot_Header h = make_header<real, integer, weights, offset>("LATCSC\0\0", numrows(G), numnodes(G), nnz(G), .0);
+
+    h.half = half_stored(G);
+
+    file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+    write_block(file, JA.data(), JA.size());
+
+    write_block(file, row_indices(G).data(), nnz(G));
+
+    if constexpr (weights::stored) {
+        write_block(file, values(G).data(), nnz(G));
+    }
+
+    file.close();
+
+    note("successful write\n");
+}
+
+// Maps a snapshot written by write_csc. The Graph borrows A, IA and JA from the
+// mapping, which stays open for as long as the Graph or a copy of it exists.
+// weights and offset must match those of the Graph that was written. JA and
+// IA are validated once (see check_csc), so a corrupt file exits with a
+// message instead of indexing out of bounds later.
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+const Graph<real, integer, weights, offset> load_csc(const std::string & file_name) {
+    const auto file = std::make_shared<const Mapped_File>(file_name);
+
+    note("successfully opened file ", file_name, '\n');
+
+    Snapshot_Header h;
+
+    if (file->size() < sizeof(h)) {
+        std::cerr << "truncated snapshot : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::memcpy(&h, file->begin(), sizeof(h));
+
+    check_header<real, integer, weights, offset>(h, "LATCSC\0\0", file_name);
+
+    if (h.rows > static_cast<std::uint64_t>(std::numeric_limits<integer>::max())
+        || h.cols >= static_cast<std::uint64_t>(std::numeric_limits<integer>::max())
+        || h.nnz > static_cast<std::uint64_t>(std::numeric_limits<offset>::max())) {
+        std::cerr << "snapshot sizes do not fit the index types : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    const std::uint64_t JA_offset = sizeof(h);
+
+    const std::uint64_t IA_offset = JA_offset + csc_align((h.cols + 1) * sizeof(offset));
+
+    const std::uint64_t A_offset = IA_offset + csc_align(h.nnz * sizeof(integer));
+
+    if (file->size() < A_offset + h.nnz * h.real_bytes) {
+        std::cerr << "truncated snapshot : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    Array<offset> JA(reinterpret_cast<const offset *>(file->begin() + JA_offset), h.cols + 1, file);
+
+    Array<integer> IA(reinterpret_cast<const integer *>(file->begin() + IA_offset), h.nnz, file);
+
+    check_csc(JA.data(), IA.data(), h.rows, h.cols, h.nnz, file_name);
+
+    note("matrix mapped to memory\n");
+
+    const bool half = h.version > 1 && h.half != 0;
+
+    if constexpr (!weights::stored) {
+        return Graph<real, integer, weights, offset>(std::move(IA), std::move(JA), h.rows, h.cols, half);
+    }
+    else {
+        Array<real> A(reinterpret_cast<const real *>(file->begin() + A_offset), h.nnz, file);
+
+        return Graph<real, integer, weights, offset>(std::move(A), std::move(IA), std::move(JA), h.rows, h.cols, half);
+    }
+}
+
+template<typename real, typename integer>
+void write_sequence_bin(const std::string & file_name, const real cost, const std::vector<integer> & s) {
+    std::ofstream file(file_name, std::ios::binary);
+
+    if (!file.is_open()) {
+        std::cerr << "unable to open file for output : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+    else {
+        note("successfully opened file ", file_name, '\n');
+    }
+
+    const Snapshot_Header h = make_header<real, integer>("LATSEQ\0\0", s.size(), 1, s.size(), cost);
+
+    file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+    write_block(file, s.data(), s.size());
+
+    file.close();
+
+    note("successful write\n");
+}
+
+template<typename real, typename integer>
+const std::vector<integer> load_sequence_bin(const std::string & file_name) {
+    const Mapped_File file(file_name);
+
+    note("successfully opened file ", file_name, '\n');
+
+    Snapshot_Header h;
+
+    if (file.size() < sizeof(h)) {
+        std::cerr << "truncated snapshot : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::memcpy(&h, file.begin(), sizeof(h));
+
+    check_header<real, integer>(h, "LATSEQ\0\0", file_name);
+
+    if (file.size() < sizeof(h) + h.rows * sizeof(integer)) {
+        std::cerr << "truncated snapshot : " << file_name << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    const integer * first = reinterpret_cast<const integer *>(file.begin() + sizeof(h));
+
+    const std::vector<integer> s(first, first + h.rows);
+
+    note("sequence loaded to memory\n");
+
+    note("best cost : ", std::fixed, h.cost, '\n');
+
+    return s;
+}
+
+}
+
+#endif
@@ -24,104 +24,352 @@
 #include <fstream>
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <charconv>
+#include <cctype>
+#include <sstream>
 #include "Graph.hh"
+#include "mapped_file.hh"
+#include "telemetry.hh"
 
 namespace lat {
 
-template<typename real, typename integer>
-const Graph<real, integer> load_mtx(std::string file_name) {
-    std::ifstream fin(file_name);
-
-    if (!fin.is_open()) {
-        std::cerr << "unable to read file : " << file_name << '\n';
+// Reads the number starting at the first non-blank character of [first, last)
+// into value and returns the position just past it, nullptr if there is none.
+template<typename T>
+const char * parse_number(const char * first, const char * last, T & value) {
+    while (first != last && (*first == ' ' || *first == '\t')) {
+        first++;
+    }
 
-        std::exit(EXIT_FAILURE);
+    if (first != last && *first == '+') {
+        first++;
     }
-    else {
-        std::clog << "successfully opened file " << file_name << '\n';
+
+    const auto [ptr, ec] = std::from_chars(first, last, value);
+
+    return ec == std::errc{} ? ptr : nullptr;
+}
+
+inline const char * next_line(const char * first, const char * last) {
+    const char * eol = static_cast<const char *>(std::memchr(first, '\n', last - first));
+
+    return eol != nullptr ? eol + 1 : last;
+}
+
+// True if the line starting at first holds an entry, i.e. is neither blank nor a comment.
+inline bool is_entry(const char * first, const char * last) {
+    while (first != last && (*first == ' ' || *first == '\t' || *first == '\r')) {
+        first++;
     }
 
-    integer rows, cols, nnz;
+    return first != last && *first != '\n' && *first != '%';
+}
 
-    while (fin.peek() == '%') {
-        fin.ignore(2048, '\n');
+// True if [first, last) starts with a Matrix Market banner declaring a
+// symmetric matrix, whose file holds one triangle. Skew-symmetric and
+// hermitian files do not count and are read as stored.
+inline bool symmetric_banner(const char * first, const char * last) {
+    std::string banner(first, next_line(first, last));
+
+    std::transform(banner.begin(), banner.end(), banner.begin(), [] (unsigned char c) { return std::tolower(c); });
+
+    std::istringstream words(banner);
+
+    std::string word;
+
+    bool symmetric = false;
+
+    words >> word;
+
+    if (word != "%%matrixmarket") {
+        return false;
     }
 
-    fin >> rows >> cols >> nnz;
+    while (words >> word) {
+        symmetric = symmetric || word == "symmetric";
+    }
 
-    std::vector<real> A(nnz);
+    return symmetric;
+}
 
-    std::vector<integer> I(nnz);
+// Builds a Graph from 0-based triplets with a stable counting sort on J. Input
+// already ordered by column, as written by SuiteSparse, is adopted in place.
+// A is ignored, and may be empty, for pattern graphs. half marks the graph as
+// half stored. I, J and A are consumed: otherwise the row indices and then the
+// values are scattered in two passes, each source array freed after its pass,
+// so that at most one array of nnz entries exists beside the triplets. Every
+// thread keeps a column histogram, and there are only as many threads as
+// there are entries per column, which bounds the histograms by max(nnz, cols).
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+const Graph<real, integer, weights, offset> triplets_to_csc(std::vector<integer> && I, std::vector<integer> && J, std::vector<real> && A,
+                                                            const integer rows, const integer cols, const bool half = false) {
+    const offset nonzeros = I.size();
+
+    std::vector<offset> JA(cols + 1, 0);
+
+    bool sorted = true;
+
+#   pragma omp parallel for reduction(&& : sorted)
+    for (offset k = 1; k < nonzeros; k++) {
+        sorted = sorted && (J[k - 1] <= J[k]);
+    }
+
+    if (sorted) {
+#       pragma omp parallel for
+        for (integer j = 0; j <= cols; j++) {
+            JA[j] = std::lower_bound(J.begin(), J.end(), j) - J.begin();
+        }
 
-    std::vector<integer> J(nnz);
+        std::vector<integer>().swap(J);
 
-    for (integer i = 0; i < nnz; i++) {
-        fin >> I[i] >> J[i] >> A[i];
+        return Graph<real, integer, weights, offset>(std::move(A), std::move(I), std::move(JA), rows, cols, half);
     }
 
-    fin.close();
+    const integer m = std::max<long long>(1, std::min<long long>(omp_get_max_threads(), nonzeros / std::max<integer>(1, cols)));
 
-    std::clog << "matrix loaded to memory";
+    std::vector<offset> offsets(static_cast<std::size_t>(m) * cols, 0);
 
-    std::transform(I.begin(), I.end(), I.begin(), [] (integer i) { 
-                                                    return i -= 1; 
-                                                  });
+    std::vector<integer> IA(nonzeros);
+
+    std::vector<real> resA;
+
+#   pragma omp parallel num_threads(m)
+    {
+        const integer procs = omp_get_num_threads(), proc = omp_get_thread_num();
+
+        const offset lb = static_cast<long long>(nonzeros) * proc / procs;
 
-    std::vector<integer> JA(cols + 1);
+        const offset ub = static_cast<long long>(nonzeros) * (proc + 1) / procs;
 
-    for (integer i = 0; i < nnz; i++) {
-        JA[J[i]] += 1;
+        offset * counts = offsets.data() + static_cast<std::size_t>(proc) * cols;
+
+        for (offset k = lb; k < ub; k++) {
+            counts[J[k]]++;
+        }
+
+#       pragma omp barrier
+
+#       pragma omp for
+        for (integer j = 0; j < cols; j++) {
+            offset sum = 0;
+
+            for (integer t = 0; t < procs; t++) {
+                sum += offsets[static_cast<std::size_t>(t) * cols + j];
+            }
+
+            JA[j + 1] = sum;
+        }
+
+#       pragma omp single
+        std::partial_sum(JA.begin(), JA.end(), JA.begin());
+
+#       pragma omp for
+        for (integer j = 0; j < cols; j++) {
+            offset start = JA[j];
+
+            for (integer t = 0; t < procs; t++) {
+                const offset count = offsets[static_cast<std::size_t>(t) * cols + j];
+
+                offsets[static_cast<std::size_t>(t) * cols + j] = start;
+
+                start += count;
+            }
+        }
+
+        for (offset k = lb; k < ub; k++) {
+            IA[counts[J[k]]++] = I[k];
+        }
+
+#       pragma omp barrier
+
+#       pragma omp single
+        {
+            std::vector<integer>().swap(I);
+
+            if constexpr (weights::stored) {
+                resA.resize(nonzeros);
+            }
+        }
+
+        if constexpr (weights::stored) {
+            // Every thread's counts now end where the next thread's start.
+#           pragma omp for
+            for (integer j = 0; j < cols; j++) {
+                for (integer t = procs - 1; t > 0; t--) {
+                    offsets[static_cast<std::size_t>(t) * cols + j] = offsets[static_cast<std::size_t>(t - 1) * cols + j];
+                }
+
+                offsets[j] = JA[j];
+            }
+
+            for (offset k = lb; k < ub; k++) {
+                resA[counts[J[k]]++] = A[k];
+            }
+        }
     }
 
-    std::partial_sum(JA.begin(), JA.end(), JA.begin());
+    std::vector<integer>().swap(J);
 
-    return Graph<real, integer>(A, I, JA, rows, cols);
+    std::vector<real>().swap(A);
+
+    std::vector<offset>().swap(offsets);
+
+    return Graph<real, integer, weights, offset>(std::move(resA), std::move(IA), std::move(JA), rows, cols, half);
 }
 
-template<typename real, typename integer>
-const std::vector<integer> load_mtx_sequence(std::string &file_name) {
-    std::ifstream fin(file_name);
+// Loads a coordinate Matrix Market file through a memory mapping into G. The
+// body is cut into chunks on line boundaries that are counted and then parsed
+// in parallel straight into the triplet arrays. Pattern files carry no values
+// and get unit weights; a Unit_Weights graph reads and stores no values at
+// all. Files with a symmetric banner give a half stored graph of the entries
+// as they are, whichever triangle they lie in. A file that cannot be read, or
+// with a malformed size line, too few entries, malformed entries or indices
+// out of range, leaves G as it was and returns false with the reason in error.
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+bool read_mtx(const std::string & file_name, const bool pattern, Graph<real, integer, weights, offset> & G, std::string & error) {
+    const Mapped_File file(file_name, &error);
+
+    if (!error.empty()) {
+        return false;
+    }
 
-    if (!fin.is_open()) {
-        std::cerr << "unable to read file : " << file_name << '\n';
+    note("successfully opened file ", file_name, '\n');
 
-        std::exit(EXIT_FAILURE);
+    const char * first = file.begin(), * last = file.end();
+
+    const bool half = symmetric_banner(first, last);
+
+    if (half) {
+        note("symmetric matrix, one triangle stored\n");
     }
-    else {
-        std::clog << "successfully opened file " << file_name << '\n';
+
+    while (first != last && !is_entry(first, last)) {
+        first = next_line(first, last);
     }
 
-    integer rows;
+    integer rows = - 1, cols = - 1;
 
-    real cost;
+    offset nonzeros = - 1;
 
-    while (fin.peek() == '%') {
-        fin.ignore(2048, '\n');
+    first = parse_number(first, last, rows);
+
+    first = first ? parse_number(first, last, cols) : nullptr;
+
+    first = first ? parse_number(first, last, nonzeros) : nullptr;
+
+    if (!first || rows < 0 || cols < 0 || nonzeros < 0) {
+        error = "malformed size line in file : " + file_name;
+
+        return false;
     }
 
-    fin >> rows >> cost;
+    first = next_line(first, last);
 
-    std::vector<integer> s(rows);
+    const integer chunks = omp_get_max_threads();
 
-    for (integer i = 0; i < rows; i++) {
-        fin >> s[i]; 
+    std::vector<const char *> bounds(chunks + 1, last);
+
+    bounds[0] = first;
+
+    for (integer c = 1; c < chunks; c++) {
+        const char * split = first + (last - first) * static_cast<long long>(c) / chunks;
+
+        bounds[c] = std::max(bounds[c - 1], split == first ? first : next_line(split - 1, last));
     }
 
-    fin.close();
+    std::vector<offset> starts(chunks + 1, 0);
 
-    std::clog << "sequence loaded to memory\n";
+#   pragma omp parallel for
+    for (integer c = 0; c < chunks; c++) {
+        offset count = 0;
 
-    std::clog << "best cost : " << std::fixed << cost << '\n';
+        for (const char * line = bounds[c]; line < bounds[c + 1]; line = next_line(line, bounds[c + 1])) {
+            count += is_entry(line, bounds[c + 1]);
+        }
 
-    std::transform(s.begin(), s.end(), s.begin(), [] (integer i) { 
-                                                    return i -= 1; 
-                                                  });
+        starts[c + 1] = count;
+    }
 
-    return s;
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+
+    if (starts[chunks] < nonzeros) {
+        error = "expected " + std::to_string(nonzeros) + " entries in file : " + file_name;
+
+        return false;
+    }
+
+    std::vector<integer> I(nonzeros), J(nonzeros);
+
+    const bool read_values = weights::stored && !pattern;
+
+    std::vector<real> A(read_values ? nonzeros : 0);
+
+    bool malformed = false;
+
+#   pragma omp parallel for reduction(|| : malformed)
+    for (integer c = 0; c < chunks; c++) {
+        offset k = starts[c];
+
+        for (const char * line = bounds[c]; line < bounds[c + 1] && k < nonzeros; line = next_line(line, bounds[c + 1])) {
+            if (is_entry(line, bounds[c + 1])) {
+                const char * ptr = parse_number(line, bounds[c + 1], I[k]);
+
+                ptr = ptr ? parse_number(ptr, bounds[c + 1], J[k]) : nullptr;
+
+                if (read_values && ptr) {
+                    ptr = parse_number(ptr, bounds[c + 1], A[k]);
+                }
+
+                malformed = malformed || !ptr || I[k] < 1 || I[k] > rows || J[k] < 1 || J[k] > cols;
+
+                I[k]--; J[k]--; k++;
+            }
+        }
+    }
+
+    if (malformed) {
+        error = "malformed entry in file : " + file_name;
+
+        return false;
+    }
+
+    if (weights::stored && pattern) {
+        A.assign(nonzeros, 1.);
+    }
+
+    G = triplets_to_csc<real, integer, weights, offset>(std::move(I), std::move(J), std::move(A), rows, cols, half);
+
+    return true;
+}
+
+// read_mtx() for the loaders below, which end the program on a bad file.
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+const Graph<real, integer, weights, offset> parse_mtx(const std::string & file_name, const bool pattern) {
+    Graph<real, integer, weights, offset> G(std::vector<integer>{}, std::vector<offset>(1, 0), 0, 0);
+
+    std::string error;
+
+    if (!read_mtx(file_name, pattern, G, error)) {
+        std::cerr << error << '\n';
+
+        std::exit(EXIT_FAILURE);
+    }
+
+    return G;
+}
+
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+const Graph<real, integer, weights, offset> load_mtx(std::string file_name) {
+    Graph<real, integer, weights, offset> G = parse_mtx<real, integer, weights, offset>(file_name, false);
+
+    note("matrix loaded to memory\n");
+
+    return G;
 }
 
 template<typename real, typename integer>
-const Graph<real, integer> load_mtx_bin(std::string & file_name) {
+const std::vector<integer> load_mtx_sequence(std::string &file_name) {
     std::ifstream fin(file_name);
 
     if (!fin.is_open()) {
@@ -130,44 +378,47 @@ const Graph<real, integer> load_mtx_bin(std::string & file_name) {
         std::exit(EXIT_FAILURE);
     }
     else {
-        std::clog << "successfully opened file " << file_name << '\n';
+        note("successfully opened file ", file_name, '\n');
     }
 
-    integer rows, cols, nnz;
+    integer rows;
+
+    real cost;
 
     while (fin.peek() == '%') {
         fin.ignore(2048, '\n');
     }
 
-    fin >> rows >> cols >> nnz;
-
-    std::vector<integer> I(nnz);
+    fin >> rows >> cost;
 
-    std::vector<integer> J(nnz);
+    std::vector<integer> s(rows);
 
-    for (integer i = 0; i < nnz; i++) {
-        fin >> I[i] >> J[i];
+    for (integer i = 0; i < rows; i++) {
+        fin >> s[i]; 
     }
 
     fin.close();
 
-    std::clog << "matrix loaded to memory\n";
+    note("sequence loaded to memory\n");
 
-    std::transform(I.begin(), I.end(), I.begin(), [] (integer i) { 
+    note("best cost : ", std::fixed, cost, '\n');
+
+    std::transform(s.begin(), s.end(), s.begin(), [] (integer i) { 
                                                     return i -= 1; 
                                                   });
 
-    std::vector<real> A(nnz, 1.);    
-
-    std::vector<integer> JA(cols + 1);
+    return s;
+}
 
-    for (integer i = 0; i < nnz; i++) {
-        JA[J[i]] += 1;
-    }
+// Loads a pattern file. With the default Stored_Weights every entry gets a
+// stored one; load_mtx_bin<real, integer, Unit_Weights> stores no values.
+template<typename real, typename integer, typename weights = Stored_Weights, typename offset = integer>
+const Graph<real, integer, weights, offset> load_mtx_bin(std::string & file_name) {
+    Graph<real, integer, weights, offset> G = parse_mtx<real, integer, weights, offset>(file_name, true);
 
-    std::partial_sum(JA.begin(), JA.end(), JA.begin());
+    note("matrix loaded to memory\n");
 
-    return Graph<real, integer>(A, I, JA, rows, cols);
+    return G;
 }
 
 template<typename real, typename integer>
@@ -182,7 +433,7 @@ void write_mtx_sequence(const std::string & file_name, const real cost, const st
         std::exit(EXIT_FAILURE);
     }
     else {
-        std::clog << "successfully opened file " << file_name << '\n';
+        note("successfully opened file ", file_name, '\n');
     }
 
     file << s.size() << ' ' << std::fixed << cost << '\n';
@@ -193,7 +444,7 @@ void write_mtx_sequence(const std::string & file_name, const real cost, const st
 
     file.close();
 
-    std::clog << "successful write\n";
+    note("successful write\n");
 }
 
 }
@@ -0,0 +1,173 @@
+// "lower_bounds.hh" -- implements template function lower_bound as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Lower bounds on la(G(sequence)) over all sequences, for non-negative
+// weights. They work on S = symmetrize(G), in which the weight of edge {u, v}
+// is that of both entries of G, so that la(G) is the sum over the edges of S
+// of weight times length.
+
+#ifndef LOWER_BOUNDS_HH
+#define LOWER_BOUNDS_HH
+
+#include "Graph.hh"
+#include "components.hh"
+#include "spectral_sequence.hh"
+
+namespace lat {
+
+// Every node has at most two neighbours at each distance, so its edges,
+// heaviest first, are at least 1, 1, 2, 2, 3, 3, ... long; summed over the
+// nodes this counts every edge twice. O(nnz log(max degree)), in parallel.
+template<typename R, typename Z, typename W, typename O>
+R degree_bound(const Graph<R, Z, W, O> & S) {
+    const auto & A = values(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z n = numnodes(S);
+
+    R sum = .0;
+
+#   pragma omp parallel reduction(+ : sum)
+    {
+        std::vector<R> w;
+
+#       pragma omp for schedule(guided)
+        for (Z v = 0; v < n; v++) {
+            if constexpr (W::stored) {
+                w.assign(A.begin() + JA[v], A.begin() + JA[v + 1]);
+            }
+            else {
+                w.assign(JA[v + 1] - JA[v], R(1));
+            }
+
+            std::sort(w.begin(), w.end(), std::greater<R>());
+
+            for (std::size_t i = 0; i < w.size(); i++) {
+                sum += w[i] * static_cast<R>(i / 2 + 1);
+            }
+        }
+    }
+
+    return sum / 2;
+}
+
+// For positions x, sum of w (x_u - x_v)^2 >= lambda_2 n (n^2 - 1) / 12, and
+// every edge is at most n - 1 long, so la >= lambda_2 n (n + 1) / 12. lambda_2
+// comes from fiedler_vector, taken as its Rayleigh quotient less the residual
+// norm; that is a true lower bound once the iteration has converged to
+// lambda_2 rather than a higher eigenvalue, which the random start makes the
+// rule. Before convergence the iterate may still mix in higher eigenvectors
+// and the bound overestimate, so without it degree_bound is returned instead.
+// O(nnz) per iteration. Meaningful for connected graphs only (lambda_2 = 0
+// otherwise); see lower_bound().
+template<typename R, typename Z, typename W, typename O>
+R spectral_bound(const Graph<R, Z, W, O> & S, const Z max_iterations = 200, const R tolerance = 1e-6) {
+    const Z n = numnodes(S);
+
+    if (n < 2) {
+        return .0;
+    }
+
+    R lambda;
+
+    bool converged;
+
+    const std::vector<R> x = fiedler_vector(S, lambda, max_iterations, tolerance, 2019U, &converged);
+
+    if (!converged) {
+        return degree_bound(S);
+    }
+
+    const auto & A = values(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    std::vector<R> D(n, .0), Lx(n);
+
+#   pragma omp parallel for
+    for (Z j = 0; j < n; j++) {
+        for (O i = JA[j]; i < JA[j + 1]; i++) {
+            D[j] += A[i];
+        }
+    }
+
+    laplacian_product(S, D, x, Lx);
+
+    R residual = .0;
+
+#   pragma omp parallel for reduction(+ : residual)
+    for (Z i = 0; i < n; i++) {
+        residual += (Lx[i] - lambda * x[i]) * (Lx[i] - lambda * x[i]);
+    }
+
+    const R lambda_2 = std::max(R(0), lambda - std::sqrt(residual));
+
+    return lambda_2 * n * (n + 1.) / 12;
+}
+
+// Best of the bounds above summed over the connected components of G, as an
+// arrangement of G lays out every component at least as long as its own best
+// arrangement. Components of up to two nodes are exact under degree_bound and
+// skip the spectral bound. Components of at least large nodes are bounded one
+// after the other with all threads, the rest concurrently.
+template<typename R, typename Z, typename W, typename O>
+R lower_bound(const Graph<R, Z, W, O> & G, const Z max_iterations = 200, const R tolerance = 1e-6, const Z large = 4096) {
+    std::vector<Z> identity(numnodes(G));
+
+    std::iota(identity.begin(), identity.end(), 0);
+
+    std::vector<Graph<R, Z, W, O>> parts;
+
+    std::vector<std::vector<Z>> members;
+
+    split_components(G, identity, parts, members);
+
+    const Z count = parts.size();
+
+    const auto bound = [&] (const Z c) {
+                           const Graph<R, Z, W, O> S = symmetrize(parts[c]);
+
+                           const R by_degree = degree_bound(S);
+
+                           return members[c].size() > 2 ? std::max(by_degree, spectral_bound(S, max_iterations, tolerance)) : by_degree;
+                       };
+
+    R sum = .0;
+
+    for (Z c = 0; c < count; c++) {
+        if (static_cast<Z>(members[c].size()) >= large) {
+            sum += bound(c);
+        }
+    }
+
+#   pragma omp parallel for schedule(dynamic) reduction(+ : sum)
+    for (Z c = 0; c < count; c++) {
+        if (static_cast<Z>(members[c].size()) < large) {
+            sum += bound(c);
+        }
+    }
+
+    return sum;
+}
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+// "mapped_file.hh" -- implements class Mapped_File as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef MAPPED_FILE_HH
+#define MAPPED_FILE_HH
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace lat {
+
+// Read-only memory mapping of a whole file, released on destruction. A file
+// that cannot be mapped ends the program, or, given error, leaves the mapping
+// empty with the reason in *error.
+class Mapped_File final {
+public:
+    Mapped_File(const std::string & file_name, std::string * error = nullptr) {
+        fd = ::open(file_name.c_str(), O_RDONLY);
+
+        struct stat st;
+
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            fail("unable to read file : " + file_name, error);
+
+            return;
+        }
+
+        length = st.st_size;
+
+        if (length > 0) {
+            addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (addr == MAP_FAILED) {
+                addr = nullptr; length = 0;
+
+                fail("unable to map file : " + file_name, error);
+
+                return;
+            }
+
+            ::madvise(addr, length, MADV_SEQUENTIAL);
+        }
+    }
+
+    Mapped_File(const Mapped_File &) = delete;
+
+    Mapped_File & operator=(const Mapped_File &) = delete;
+
+    const char * begin() const { return static_cast<const char *>(addr); }
+
+    const char * end() const { return begin() + length; }
+
+    std::size_t size() const { return length; }
+
+    ~Mapped_File() {
+        if (addr != nullptr) {
+            ::munmap(addr, length);
+        }
+
+        if (fd > - 1) {
+            ::close(fd);
+        }
+    }
+
+private:
+    static void fail(const std::string & message, std::string * error) {
+        if (error == nullptr) {
+            std::cerr << message << '\n';
+
+            std::exit(EXIT_FAILURE);
+        }
+
+        *error = message;
+    }
+
+    int fd = - 1;
+
+    void * addr = nullptr;
+
+    std::size_t length = 0;
+};
+
+}
+
+#endif
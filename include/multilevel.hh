@@ -0,0 +1,486 @@
+// "multilevel.hh" -- implements template function multilevel_sequence as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef MULTILEVEL_HH
+#define MULTILEVEL_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "cuthill_mckee.hh"
+#include "full_search.hh"
+#include "successive_augmentation.hh"
+
+namespace lat {
+
+// Rank of edge {u, v} among edges of equal weight; the same seen from either end.
+template<typename Z>
+inline unsigned long long edge_rank(const Z u, const Z v) {
+    unsigned long long h = (static_cast<unsigned long long>(std::min(u, v)) << 32) ^ static_cast<unsigned long long>(std::max(u, v));
+
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdULL; h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL; h ^= h >> 33;
+
+    return h;
+}
+
+// Heavy-edge matching of the undirected adjacency S. In every round each
+// unmatched node proposes to its heaviest unmatched neighbour, with equal
+// weights ordered by edge_rank, and mutual proposals are matched. Both ends
+// of an edge agree on its order, so every round matches at least the locally
+// dominant edges, and the result does not depend on the number of threads.
+// match[v] is - 1 for unmatched nodes.
+template<typename R, typename Z, typename W, typename O>
+const std::vector<Z> heavy_edge_matching(const Graph<R, Z, W, O> & S, const Z rounds = 8) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z n = numnodes(S);
+
+    std::vector<Z> match(n, - 1), proposal(n, - 1);
+
+    for (Z round = 0; round < rounds; round++) {
+#       pragma omp parallel for schedule(guided)
+        for (Z v = 0; v < n; v++) {
+            Z best = - 1;
+
+            if (match[v] < 0) {
+                for (O k = JA[v]; k < JA[v + 1]; k++) {
+                    const Z u = IA[k];
+
+                    if (match[u] < 0 && (best < 0 || A[k] > A[best] ||
+                                         (A[k] == A[best] && edge_rank(v, u) > edge_rank(v, IA[best])))) {
+                        best = k;
+                    }
+                }
+            }
+
+            proposal[v] = best < 0 ? - 1 : IA[best];
+        }
+
+        Z matched = 0;
+
+#       pragma omp parallel for reduction(+ : matched)
+        for (Z v = 0; v < n; v++) {
+            const Z u = proposal[v];
+
+            if (u > - 1 && proposal[u] == v) {
+                match[v] = u; matched++;
+            }
+        }
+
+        if (matched == 0) {
+            break;
+        }
+    }
+
+    return match;
+}
+
+// Pairs up nodes heavy_edge_matching left unmatched that share a neighbour,
+// such as the leaves of a hub, which no edge matching can shrink. Unmatched
+// nodes are grouped by their heaviest neighbour (equal weights ordered by
+// edge_rank), isolated nodes all in one group, and consecutive nodes of a
+// group are matched. O(n + nnz), and independent of the number of threads.
+template<typename R, typename Z, typename W, typename O>
+void two_hop_matching(const Graph<R, Z, W, O> & S, std::vector<Z> & match) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z n = numnodes(S);
+
+    std::vector<Z> key(n, - 1);
+
+#   pragma omp parallel for schedule(guided)
+    for (Z v = 0; v < n; v++) {
+        if (match[v] < 0) {
+            Z best = - 1;
+
+            for (O k = JA[v]; k < JA[v + 1]; k++) {
+                if (best < 0 || A[k] > A[best] || (A[k] == A[best] && edge_rank(v, IA[k]) > edge_rank(v, IA[best]))) {
+                    best = k;
+                }
+            }
+
+            key[v] = best < 0 ? n : IA[best];
+        }
+    }
+
+    std::vector<Z> first(n + 2, 0), group;
+
+    for (Z v = 0; v < n; v++) {
+        if (key[v] > - 1) {
+            first[key[v] + 1]++;
+        }
+    }
+
+    std::partial_sum(first.begin(), first.end(), first.begin());
+
+    group.resize(first[n + 1]);
+
+    std::vector<Z> next(first.begin(), first.end() - 1);
+
+    for (Z v = 0; v < n; v++) {
+        if (key[v] > - 1) {
+            group[next[key[v]]++] = v;
+        }
+    }
+
+    for (Z h = 0; h <= n; h++) {
+        for (Z i = first[h]; i + 1 < first[h + 1]; i += 2) {
+            match[group[i]] = group[i + 1]; match[group[i + 1]] = group[i];
+        }
+    }
+}
+
+// Contracts every matched pair of S into one node. map receives the coarse
+// node of each fine node; coarse nodes are numbered in the order of their
+// smallest fine node, and parallel edges are merged by adding their weights,
+// so the coarse graph stores its weights even if S is a pattern graph.
+template<typename R, typename Z, typename W, typename O>
+const Graph<R, Z, Stored_Weights, O> contract(const Graph<R, Z, W, O> & S, const std::vector<Z> & match, std::vector<Z> & map) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z n = numnodes(S);
+
+    map.assign(n, 0);
+
+    for (Z v = 0, c = 0; v < n; v++) {
+        if (match[v] < 0 || v < match[v]) {
+            map[v] = c++;
+        }
+        else {
+            map[v] = map[match[v]];
+        }
+    }
+
+    const Z nc = n > 0 ? * std::max_element(map.begin(), map.end()) + 1 : 0;
+
+    std::vector<Z> leader(nc);
+
+#   pragma omp parallel for
+    for (Z v = 0; v < n; v++) {
+        if (match[v] < 0 || v < match[v]) {
+            leader[map[v]] = v;
+        }
+    }
+
+    std::vector<O> resJA(nc + 1, 0);
+
+#   pragma omp parallel for
+    for (Z c = 0; c < nc; c++) {
+        const Z a = leader[c], b = match[a];
+
+        resJA[c + 1] = (JA[a + 1] - JA[a]) + (b < 0 ? 0 : JA[b + 1] - JA[b]);
+    }
+
+    std::partial_sum(resJA.begin(), resJA.end(), resJA.begin());
+
+    std::vector<std::pair<Z, R>> entries(resJA[nc]);
+
+    std::vector<O> counts(nc + 1, 0);
+
+#   pragma omp parallel for schedule(guided)
+    for (Z c = 0; c < nc; c++) {
+        const Z a = leader[c], b = match[a];
+
+        auto first = entries.begin() + resJA[c], last = first;
+
+        for (const Z v : {a, b}) {
+            if (v < 0) {
+                continue;
+            }
+
+            for (O k = JA[v]; k < JA[v + 1]; k++) {
+                if (map[IA[k]] != c) {
+                    *last++ = std::make_pair(map[IA[k]], A[k]);
+                }
+            }
+        }
+
+        std::sort(first, last, [] (const std::pair<Z, R> & x, const std::pair<Z, R> & y) {
+                                   return x.first < y.first;
+                               });
+
+        auto top = first;
+
+        for (auto it = first; it != last; it++) {
+            if (top != first && (top - 1)->first == it->first) {
+                (top - 1)->second += it->second;
+            }
+            else {
+                *top++ = *it;
+            }
+        }
+
+        counts[c + 1] = top - first;
+    }
+
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+    std::vector<R> resA(counts[nc]);
+
+    std::vector<Z> resIA(counts[nc]);
+
+#   pragma omp parallel for
+    for (Z c = 0; c < nc; c++) {
+        for (O k = counts[c]; k < counts[c + 1]; k++) {
+            resIA[k] = entries[resJA[c] + k - counts[c]].first; resA[k] = entries[resJA[c] + k - counts[c]].second;
+        }
+    }
+
+    return Graph<R, Z, Stored_Weights, O>(std::move(resA), std::move(resIA), std::move(counts), nc, nc);
+}
+
+// Damped Jacobi relaxation: every node is moved halfway towards the weighted
+// mean position of its neighbours and the nodes are re-sorted, ties keeping
+// their current order.
+template<typename R, typename Z, typename W, typename O>
+void relax(const Graph<R, Z, W, O> & S, std::vector<Z> & sequence, std::vector<Z> & pos) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z n = sequence.size();
+
+    std::vector<R> x(n);
+
+#   pragma omp parallel for schedule(guided)
+    for (Z v = 0; v < n; v++) {
+        R sum = .0, weight = .0;
+
+        for (O k = JA[v]; k < JA[v + 1]; k++) {
+            sum += A[k] * pos[IA[k]]; weight += A[k];
+        }
+
+        x[v] = weight > 0 ? (pos[v] + sum / weight) / 2 : pos[v];
+    }
+
+    std::stable_sort(sequence.begin(), sequence.end(), [&x] (const Z a, const Z b) {
+                                                          return x[a] < x[b];
+                                                      });
+
+#   pragma omp parallel for
+    for (Z i = 0; i < n; i++) {
+        pos[sequence[i]] = i;
+    }
+}
+
+// Improves sequence in passes of one relax() step followed by swaps of nodes
+// at most window positions apart. For the swaps the positions are cut into
+// blocks of 8 * window; even and then odd blocks are swept in parallel, each
+// against a snapshot of the positions outside it. Each step is kept only if
+// the true cost went down, so the result never gets worse and does not depend
+// on the number of threads.
+template<typename R, typename Z, typename W, typename O>
+void refine(const Graph<R, Z, W, O> & S, std::vector<Z> & sequence, const Z window, const Z passes) {
+    const Z n = sequence.size();
+
+    const Z block = 8 * std::max(window, Z(1));
+
+    const Z blocks = (n + block - 1) / block;
+
+    std::vector<Z> pos = positions(sequence), previous;
+
+    R cost = parallel_la(Arrangement<R, Z, W, O>(S, sequence));
+
+    const auto keep_if_better = [&] () {
+                                    const R new_cost = parallel_la(Arrangement<R, Z, W, O>(S, sequence));
+
+                                    if (new_cost < cost) {
+                                        cost = new_cost;
+
+                                        return true;
+                                    }
+
+                                    sequence = previous;
+
+                                    pos = positions(sequence);
+
+                                    return false;
+                                };
+
+    for (Z pass = 0; pass < passes; pass++) {
+        previous = sequence;
+
+        relax(S, sequence, pos);
+
+        bool improved = keep_if_better();
+
+        previous = sequence;
+
+        for (Z parity = 0; parity < 2; parity++) {
+#           pragma omp parallel
+            {
+                std::vector<Z> local(block);
+
+#               pragma omp for schedule(dynamic)
+                for (Z b = parity; b < blocks; b += 2) {
+                    const Z lo = b * block, hi = std::min(n, lo + block);
+
+                    std::iota(local.begin(), local.begin() + (hi - lo), lo);
+
+                    const auto position = [&] (const Z u) {
+                                              const Z q = pos[u];
+
+                                              return (q >= lo && q < hi) ? local[q - lo] : q;
+                                          };
+
+                    bool swapped = true;
+
+                    for (Z sweep = 0; swapped && sweep < passes; sweep++) {
+                        swapped = false;
+
+                        for (Z i = lo; i < hi - 1; i++) {
+                            for (Z j = i + 1; j < std::min(hi, i + window + 1); j++) {
+                                const Z a = sequence[i], c = sequence[j];
+
+                                if (swap_delta(S, a, c, i, j, position) < 0) {
+                                    std::swap(sequence[i], sequence[j]);
+
+                                    local[pos[a] - lo] = j; local[pos[c] - lo] = i;
+
+                                    swapped = true;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+#           pragma omp parallel for
+            for (Z i = 0; i < n; i++) {
+                pos[sequence[i]] = i;
+            }
+        }
+
+        improved = keep_if_better() || improved;
+
+        if (!improved) {
+            break;
+        }
+    }
+}
+
+// Multilevel V-cycle: G is coarsened by heavy-edge matching, completed by
+// two_hop_matching when it would shrink a level by less than a tenth, until
+// at most coarsest nodes remain or even that stalls. The coarsest graph is
+// ordered by successive_augmentation followed by 2-swap descent, or, if it is
+// still larger than coarsest, by bfs_sequence and refine(), so that no step is
+// quadratic in n. The order is projected back level by level, children of a
+// coarse node kept adjacent, and refined with refine() on every level.
+// The levels store weights; for a pattern G the symmetrized graph is first
+// contracted with nothing matched, which merges its parallel unit entries.
+template<typename R, typename Z, typename W, typename O>
+const std::vector<Z> multilevel_sequence(const Graph<R, Z, W, O> & G, const Z coarsest = 128, const Z window = 8, const Z passes = 8) {
+    std::vector<Graph<R, Z, Stored_Weights, O>> levels;
+
+    std::vector<std::vector<Z>> maps;
+
+    if constexpr (W::stored) {
+        levels.push_back(symmetrize(G));
+    }
+    else {
+        std::vector<Z> identity;
+
+        levels.push_back(contract(symmetrize(G), std::vector<Z>(numnodes(G), - 1), identity));
+    }
+
+    while (numnodes(levels.back()) > coarsest) {
+        const Z n = numnodes(levels.back());
+
+        std::vector<Z> match = heavy_edge_matching(levels.back()), map;
+
+        if (std::count_if(match.begin(), match.end(), [] (const Z u) { return u > - 1; }) < 0.2 * n) {
+            two_hop_matching(levels.back(), match);
+        }
+
+        Graph<R, Z, Stored_Weights, O> coarse = contract(levels.back(), match, map);
+
+        if (numnodes(coarse) > 0.9 * n) {
+            break;
+        }
+
+        levels.push_back(std::move(coarse));
+
+        maps.push_back(std::move(map));
+    }
+
+    const Graph<R, Z, Stored_Weights, O> & C = levels.back();
+
+    std::vector<Z> sequence(numnodes(C));
+
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    if (numnodes(C) <= coarsest) {
+        sequence = successive_augmentation(C, sequence);
+
+        Arrangement<R, Z, Stored_Weights, O> P(C, sequence);
+
+        while (select_best_swap(C, P) < 0) { ; }
+
+        sequence = P.sequence();
+    }
+    else {
+        sequence = bfs_sequence(C);
+
+        refine(C, sequence, window, passes);
+    }
+
+    for (Z level = maps.size(); level > 0; level--) {
+        const std::vector<Z> & map = maps[level - 1];
+
+        const Z n = map.size(), nc = sequence.size();
+
+        std::vector<Z> first(nc + 1, 0), coarse_pos = positions(sequence);
+
+        for (Z v = 0; v < n; v++) {
+            first[coarse_pos[map[v]] + 1]++;
+        }
+
+        std::partial_sum(first.begin(), first.end(), first.begin());
+
+        std::vector<Z> fine(n);
+
+        for (Z v = 0; v < n; v++) {
+            fine[first[coarse_pos[map[v]]]++] = v;
+        }
+
+        sequence = std::move(fine);
+
+        refine(levels[level - 1], sequence, window, passes);
+    }
+
+    return sequence;
+}
+
+}
+
+#endif
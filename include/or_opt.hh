@@ -0,0 +1,365 @@
+// "or_opt.hh" -- implements template function or_opt as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef OR_OPT_HH
+#define OR_OPT_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "budget.hh"
+#include <deque>
+#include <cmath>
+#include <limits>
+
+namespace lat {
+
+// Fiduccia-Mattheyses gain buckets: nodes are kept in doubly linked lists
+// indexed by their gain quantised to 2 * keys + 1 buckets spanning [- bound,
+// bound] (gains outside are clamped to the end buckets). Positive gains are
+// rounded up and the others down, so the middle bucket holds gain <= 0 only
+// and top() is an improving move whenever there is one. Insertion and removal
+// are O(1) and top() is O(1) amortised, the top bucket only moving down lazily.
+template<typename R, typename Z>
+class Gain_Buckets final {
+public:
+    Gain_Buckets(const Z n, const R bound, const Z keys = 1024) :
+    K{keys}, quantum{bound > 0 ? bound / keys : R(1)}, top_bucket{- 1},
+    head(2 * keys + 1, - 1), next(n, - 1), prev(n, - 1), bucket(n, - 1) { ; }
+
+    bool contains(const Z v) const { return bucket[v] > - 1; }
+
+    void insert(const Z v, const R gain) {
+        const R k = gain > 0 ? std::max<R>(1, std::ceil(gain / quantum)) : std::floor(gain / quantum);
+
+        const Z b = static_cast<Z>(std::max<R>(- K, std::min<R>(K, k))) + K;
+
+        bucket[v] = b; prev[v] = - 1; next[v] = head[b];
+
+        if (head[b] > - 1) {
+            prev[head[b]] = v;
+        }
+
+        head[b] = v;
+
+        top_bucket = std::max(top_bucket, b);
+    }
+
+    void remove(const Z v) {
+        const Z b = bucket[v];
+
+        if (b < 0) {
+            return;
+        }
+
+        if (prev[v] > - 1) {
+            next[prev[v]] = next[v];
+        }
+        else {
+            head[b] = next[v];
+        }
+
+        if (next[v] > - 1) {
+            prev[next[v]] = prev[v];
+        }
+
+        bucket[v] = - 1;
+    }
+
+    // A node of the highest non-empty bucket, - 1 if there is none.
+    Z top() {
+        while (top_bucket > - 1 && head[top_bucket] < 0) {
+            top_bucket--;
+        }
+
+        return top_bucket > - 1 ? head[top_bucket] : - 1;
+    }
+
+    ~Gain_Buckets() { ; }
+
+private:
+    const Z K;
+
+    const R quantum;
+
+    Z top_bucket;
+
+    std::vector<Z> head, next, prev, bucket;
+};
+
+// Left-hand weights of node v at position i over positions [lo, hi + 1]:
+// L[x - lo] is the weight of v's edges to nodes in front of position x.
+// Returns the total weight of v's edges.
+template<typename R, typename Z, typename W, typename O>
+R left_weights(const Graph<R, Z, W, O> & S, const Arrangement<R, Z, W, O> & P, const Z v, const Z lo, const Z hi, std::vector<R> & L) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    L.assign(hi - lo + 2, .0);
+
+    R total = .0;
+
+    for (O k = JA[v]; k < JA[v + 1]; k++) {
+        const Z q = P.position(IA[k]);
+
+        total += A[k];
+
+        if (q <= hi) {
+            L[std::max(Z(0), q + 1 - lo)] += A[k];
+        }
+    }
+
+    for (Z x = lo; x <= hi; x++) {
+        L[x - lo + 1] += L[x - lo];
+    }
+
+    return total;
+}
+
+// Best relocation of the node at position i to a position at most reach away.
+// cut[b] is the weight of the edges crossing the boundary in front of position
+// b. Moving the node to t > i gives the boundaries i + 1 .. t the cut of the
+// next one with v on the other side, so the cost change is
+//
+//     cut[t + 1] - cut[i + 1] + sum over x = i + 2 .. t + 1 of (L(x) - R(x))
+//
+// and symmetrically to the left; all targets are scored in O(reach + deg(v)).
+// Returns the gain (cost reduction) and sets target, which is i if the node
+// has no position to go to.
+template<typename R, typename Z, typename W, typename O>
+R relocation_gain(const Graph<R, Z, W, O> & S, const Arrangement<R, Z, W, O> & P, const std::vector<R> & cut, const Z i, const Z reach,
+                  Z & target, std::vector<R> & L) {
+    const Z n = P.size(), lo = std::max(Z(0), i - reach), hi = std::min(n - 1, i + reach);
+
+    const R total = left_weights(S, P, P[i], lo, hi, L);
+
+    const auto balance = [&] (const Z x) { return 2 * L[x - lo] - total; };
+
+    R best = std::numeric_limits<R>::infinity(), delta = .0;
+
+    target = i;
+
+    for (Z t = i + 1; t <= hi; t++) {
+        delta += balance(t + 1);
+
+        if (cut[t + 1] - cut[i + 1] + delta < best) {
+            best = cut[t + 1] - cut[i + 1] + delta; target = t;
+        }
+    }
+
+    delta = .0;
+
+    for (Z t = i - 1; t >= lo; t--) {
+        delta -= balance(t);
+
+        if (cut[t] - cut[i] + delta < best) {
+            best = cut[t] - cut[i] + delta; target = t;
+        }
+    }
+
+    return - best;
+}
+
+// Moves the node at position i to position t and updates cut, O(|t - i| + deg).
+template<typename R, typename Z, typename W, typename O>
+void relocate(const Graph<R, Z, W, O> & S, Arrangement<R, Z, W, O> & P, std::vector<R> & cut, const Z i, const Z t, std::vector<R> & L) {
+    const Z lo = std::min(i, t), hi = std::max(i, t);
+
+    const R total = left_weights(S, P, P[i], lo, hi, L);
+
+    const auto balance = [&] (const Z x) { return 2 * L[x - lo] - total; };
+
+    if (i < t) {
+        for (Z b = i + 1; b <= t; b++) {
+            cut[b] = cut[b + 1] + balance(b + 1);
+        }
+    }
+    else {
+        for (Z b = i; b > t; b--) {
+            cut[b] = cut[b - 1] - balance(b - 1);
+        }
+    }
+
+    P.insert(i, t);
+}
+
+// Node relocation (Or-opt) local search from sequence. Each node's best move
+// within reach positions is kept in Gain_Buckets, so the best move is found
+// in O(1); after a move only the nodes within reach of the shifted positions
+// and the moved node's neighbours are rescored. With tenure = 0 the search
+// stops at the first local minimum; otherwise moved nodes are tabu for tenure
+// moves, non-improving moves are taken when nothing improves, and the best
+// sequence of at most max_moves moves is returned. The search also ends,
+// with the best sequence so far, once the time of budget runs out or its
+// token is cancelled, which is checked every 1024 moves.
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> or_opt(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, const Z reach = 16, const Z tenure = 0,
+                      const unsigned long long max_moves = 1000000, const Budget & budget = Budget{}) {
+    Stopwatch clock;
+
+    const Z n = sequence.size();
+
+    if (n < 2 || reach < 1) {
+        return sequence;
+    }
+
+    const Graph<R, Z, W, O> S = symmetrize(G);
+
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    Arrangement<R, Z, W, O> P(S, sequence);
+
+    std::vector<R> cut(n + 1, .0);
+
+    R max_degree = .0;
+
+    for (Z v = 0; v < n; v++) {
+        R degree = .0;
+
+        for (O k = JA[v]; k < JA[v + 1]; k++) {
+            const Z a = P.position(v), b = P.position(IA[k]);
+
+            if (a < b) {
+                cut[a + 1] += A[k]; cut[b + 1] -= A[k];
+            }
+
+            degree += A[k];
+        }
+
+        max_degree = std::max(max_degree, degree);
+    }
+
+    std::partial_sum(cut.begin(), cut.end(), cut.begin());
+
+    std::vector<R> gain(n);
+
+    std::vector<Z> target(n);
+
+#   pragma omp parallel
+    {
+        std::vector<R> L;
+
+#       pragma omp for schedule(guided)
+        for (Z v = 0; v < n; v++) {
+            gain[v] = relocation_gain(S, P, cut, P.position(v), reach, target[v], L);
+        }
+    }
+
+    Gain_Buckets<R, Z> buckets(n, 2 * reach * max_degree);
+
+    for (Z v = 0; v < n; v++) {
+        if (target[v] != P.position(v)) {
+            buckets.insert(v, gain[v]);
+        }
+    }
+
+    std::vector<R> L;
+
+    std::vector<char> tabu(n, false);
+
+    std::deque<std::pair<unsigned long long, Z>> released;
+
+    const auto rescore = [&] (const Z v) {
+                             buckets.remove(v);
+
+                             gain[v] = relocation_gain(S, P, cut, P.position(v), reach, target[v], L);
+
+                             if (target[v] != P.position(v)) {
+                                 buckets.insert(v, gain[v]);
+                             }
+                         };
+
+    R cost = .0, best_cost = .0;
+
+    std::vector<Z> best;
+
+    bool at_best = true;
+
+    for (unsigned long long move = 0; move < max_moves; move++) {
+        if (move % 1024 == 1023 && budget.exhausted(clock, 0)) {
+            break;
+        }
+
+        while (!released.empty() && released.front().first <= move) {
+            const Z v = released.front().second;
+
+            released.pop_front();
+
+            tabu[v] = false;
+
+            rescore(v);
+        }
+
+        const Z v = buckets.top();
+
+        if (v < 0 || (tenure == 0 && !(gain[v] > 0))) {
+            break;
+        }
+
+        if (!(gain[v] > 0) && at_best) {
+            best = P.sequence(); at_best = false;
+        }
+
+        const Z i = P.position(v), t = target[v];
+
+        relocate(S, P, cut, i, t, L);
+
+        cost -= gain[v];
+
+        if (cost < best_cost) {
+            best_cost = cost; at_best = true;
+        }
+
+        buckets.remove(v);
+
+        if (tenure > 0) {
+            tabu[v] = true;
+
+            released.emplace_back(move + tenure, v);
+        }
+        else {
+            rescore(v);
+        }
+
+        for (Z q = std::max(Z(0), std::min(i, t) - reach); q <= std::min(n - 1, std::max(i, t) + reach); q++) {
+            if (!tabu[P[q]] && P[q] != v) {
+                rescore(P[q]);
+            }
+        }
+
+        for (O k = JA[v]; k < JA[v + 1]; k++) {
+            if (!tabu[IA[k]]) {
+                rescore(IA[k]);
+            }
+        }
+    }
+
+    return at_best ? P.sequence() : best;
+}
+
+}
+
+#endif
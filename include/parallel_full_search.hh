@@ -22,122 +22,150 @@
 #define PARALLEL_FULL_SEARCH_HH
 
 #include "Graph.hh"
+#include "Arrangement.hh"
+#include "telemetry.hh"
+#include "budget.hh"
 #include <omp.h>
-#include <cmath>
 #include <vector>
+#include <tuple>
+#include <numeric>
 
 namespace lat {
     
-template<typename R, typename Z>
-std::vector<Z> parallel_full_search(const Graph<R, Z> & G, std::vector<Z> sequence) {
-    R min_cost = la(G(sequence));
+// Parallel counterpart of full_search, reporting to observer in the same way
+// plus the swaps every thread scored in on_thread_work, and checking budget
+// after every swap applied as full_search does.
+template<typename R, typename Z, typename W, typename O, typename Observer = Null_Observer>
+std::vector<Z> parallel_full_search(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence, Observer && observer = Observer{},
+                                    const Budget & budget = Budget{}) {
+    Stopwatch clock;
 
-    Z z =0; Z cnt = 0;
+    const Graph<R, Z, W, O> S = symmetrize(G);
 
-    while (z < 1) {
-        z++;
+    Arrangement<R, Z, W, O> P(G, sequence);
 
-        std::cout << cnt << ' '  << min_cost << '\n';
+    observer.on_phase("symmetrize", clock.split());
 
-        R new_cost;
+    std::vector<unsigned long long> work(omp_get_max_threads(), 0);
 
-        parallel_select_best_neighbor(G, sequence, new_cost);
+    Progress progress;
 
-        if (new_cost < min_cost) {
-            cnt++;
+    progress.cost = la(P);
 
-            z = 0;
+    bool stop = budget.exhausted(clock, 0) || budget.reached(progress.cost);
 
-            min_cost = new_cost;
-        }
-    }
+    Z z = 0;
 
-    return sequence;
-}
+    while (z < 1 && !stop) {
+        z++;
 
-template<typename R, typename Z, typename ZIter, typename RIter>
-void parallel_select_best_local_neighbor(const Graph<R, Z> & G, std::vector<Z> sequence, 
-                                         const Z n, const Z m, const Z proc, const Z range, const Z mid, 
-                                         ZIter I_begin, ZIter J_begin, RIter min_costs_begin, R min_cost) {
-    const Z start = proc * range;
+        clock.stamp(progress);
 
-    const Z finish = proc != (m - 1) ? start + range : mid;
+        observer.on_iteration(progress);
 
-    const Z s_start = std::max(n - 1 - finish, finish);
+        const R delta = parallel_select_best_swap(S, P, &work);
 
-    const Z s_finish = n - 1 - start;
+        progress.moves_evaluated = std::accumulate(work.begin(), work.end(), 0ULL);
 
-    Z ii = 0, jj = 0;
+        if (delta < 0) {
+            progress.iteration++;
 
-    for (Z i = start; i < finish; i++) {
-        for (Z j = i + 1; j < n; j++) {
-            std::swap(sequence[i], sequence[j]);
+            z = 0;
 
-            const R new_cost = la(G(sequence));
+            progress.cost += delta;
 
-            if (new_cost < min_cost) {
-                min_cost = new_cost;
+            stop = budget.exhausted(clock, progress.moves_evaluated) || budget.reached(progress.cost);
+        }
+    }
 
-                ii = i; jj = j;
-            }
+    observer.on_phase("search", clock.split());
 
-            std::swap(sequence[i], sequence[j]);
-        }
+    for (std::size_t proc = 0; proc < work.size(); proc++) {
+        observer.on_thread_work(proc, work[proc]);
     }
 
-    for (Z i = s_start; i < s_finish; i++) {
-        for (Z j = i + 1; j < n; j++) {
-            std::swap(sequence[i], sequence[j]);
+    clock.stamp(progress);
 
-            const R new_cost = la(G(sequence));
+    observer.on_finish(progress);
 
-            if (new_cost < min_cost) {
-                min_cost = new_cost;
+    return P.sequence();
+}
 
-                ii = i; jj = j;
-            }
+// Parallel counterpart of select_best_swap: applies the best improving swap and
+// returns its cost change (.0 if sequence is already a local minimum). Rows i
+// of the triangular (i, j) space are handed out dynamically to the threads set
+// by OMP_NUM_THREADS, in increasing order within each thread (monotonic), so
+// every thread's first best swap is its smallest (i, j); ties between threads
+// are broken the same way, so the move chosen is that of select_best_swap
+// for any number of threads. If work
+// is given, it must hold a counter per thread and work[t] is increased by the
+// swaps thread t scored.
+template<typename R, typename Z, typename W, typename O>
+const R parallel_select_best_swap(const Graph<R, Z, W, O> & S, Arrangement<R, Z, W, O> & P, std::vector<unsigned long long> * work = nullptr) {
+    const Z n = numnodes(S);
+
+    const Z m = omp_get_max_threads();
 
-            std::swap(sequence[i], sequence[j]);
-        }
-    }
+    std::vector<Z> I(m, 0);
 
-    *(I_begin + proc) = ii; *(J_begin + proc) = jj; *(min_costs_begin + proc) = min_cost;
-}
+    std::vector<Z> J(m, 0);
 
-template<typename Iter>
-const auto argmin(Iter start, Iter finish) {
-    return std::distance(start, std::min_element(start, finish));
-}
+    std::vector<R> min_deltas(m, .0);
 
-template<typename R, typename Z>
-void parallel_select_best_neighbor(const Graph<R, Z> & G, std::vector<Z> & sequence, R & min_cost) {
-    const Z n = numnodes(G);
+#   pragma omp parallel num_threads(m)
+    {
+        const Z proc = omp_get_thread_num();
 
-    const Z m = omp_get_num_procs();
+        Z ii = 0, jj = 0;
 
-    min_cost = la(G(sequence));
+        R min_delta = .0;
 
-    std::vector<Z> I(m, 0);
+        unsigned long long scored = 0;
 
-    std::vector<Z> J(m, 0);
+#       pragma omp for schedule(monotonic: dynamic) nowait
+        for (Z i = 0; i < n - 1; i++) {
+            scored += n - 1 - i;
+
+            for (Z j = i + 1; j < n; j++) {
+                const R delta = swap_delta(S, P, i, j);
+
+                if (delta < min_delta) {
+                    min_delta = delta;
+
+                    ii = i; jj = j;
+                }
+            }
+        }
 
-    std::vector<R> min_costs(m, min_cost);
+        I[proc] = ii; J[proc] = jj; min_deltas[proc] = min_delta;
 
-    const Z range = std::lround(n / (2. * m));
+        if (work) {
+            (*work)[proc] += scored;
+        }
+    }
 
-    const Z mid = n / 2;
+    Z min_idx = 0;
 
-#   pragma omp parallel for
-    for (Z proc = 0; proc < m; proc++) {
-        parallel_select_best_local_neighbor(G, sequence, n, m, proc, range, mid, 
-                                            I.begin(), J.begin(), min_costs.begin(), min_cost);
+    for (Z proc = 1; proc < m; proc++) {
+        if (std::tie(min_deltas[proc], I[proc], J[proc]) < std::tie(min_deltas[min_idx], I[min_idx], J[min_idx])) {
+            min_idx = proc;
+        }
     }
 
-    const Z min_idx = argmin(min_costs.begin(), min_costs.end());
+    P.swap(I[min_idx], J[min_idx]);
+
+    return min_deltas[min_idx];
+}
+
+template<typename R, typename Z, typename W, typename O>
+void parallel_select_best_neighbor(const Graph<R, Z, W, O> & G, std::vector<Z> & sequence, R & min_cost) {
+    Arrangement<R, Z, W, O> P(G, sequence);
+
+    min_cost = la(P);
 
-    std::swap(sequence[I[min_idx]], sequence[J[min_idx]]);
+    min_cost += parallel_select_best_swap(symmetrize(G), P);
 
-    min_cost = min_costs[min_idx];
+    sequence = P.sequence();
 }
 
 }
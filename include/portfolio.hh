@@ -0,0 +1,256 @@
+// "portfolio.hh" -- implements template function portfolio as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef PORTFOLIO_HH
+#define PORTFOLIO_HH
+
+#include "Graph.hh"
+#include "Arrangement.hh"
+#include "anytime_search.hh"
+#include "annealing.hh"
+#include "or_opt.hh"
+#include "successive_augmentation.hh"
+#include "window_dp.hh"
+#include <functional>
+
+namespace lat {
+
+// Best sequence found so far, shared by concurrent searches without locks.
+// Solutions are immutable once published and replaced by a compare-and-swap
+// of the head pointer, so readers never wait and never see a torn sequence.
+// Superseded solutions stay chained behind the head, as a reader may still
+// hold one, and are freed with the incumbent; one sequence is kept per
+// improvement.
+template<typename R, typename Z>
+class Incumbent final {
+public:
+    struct Solution final {
+        R cost;
+
+        std::vector<Z> sequence;
+
+        const Solution * previous;
+    };
+
+    Incumbent(const R cost, const std::vector<Z> & sequence) : head{new Solution{cost, sequence, nullptr}} { ; }
+
+    Incumbent(const Incumbent &) = delete;
+
+    Incumbent & operator=(const Incumbent &) = delete;
+
+    const Solution & best() const { return * head.load(std::memory_order_acquire); }
+
+    // Publishes sequence if its cost beats the incumbent; returns whether it did.
+    bool offer(const R cost, const std::vector<Z> & sequence) {
+        const Solution * current = head.load(std::memory_order_acquire);
+
+        if (!(cost < current->cost)) {
+            return false;
+        }
+
+        Solution * candidate = new Solution{cost, sequence, current};
+
+        while (!head.compare_exchange_weak(current, candidate, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            if (!(cost < current->cost)) {
+                delete candidate;
+
+                return false;
+            }
+
+            candidate->previous = current;
+        }
+
+        return true;
+    }
+
+    ~Incumbent() {
+        const Solution * s = head.load();
+
+        while (s) {
+            const Solution * previous = s->previous;
+
+            delete s;
+
+            s = previous;
+        }
+    }
+
+private:
+    std::atomic<const Solution *> head;
+};
+
+// A strategy improves (or replaces) a start sequence of G; seed makes every
+// call of a randomised strategy different and reproducible. budget is what is
+// left of the caller's (see Budget::remaining); a strategy that runs long
+// should check it and return its best sequence once it is exhausted.
+template<typename R, typename Z, typename W = Stored_Weights, typename O = Z>
+using Strategy = std::function<std::vector<Z> (const Graph<R, Z, W, O> & G, const std::vector<Z> & start, unsigned long long seed,
+                                               const Budget & budget)>;
+
+// Position-averaging crossover: nodes ordered by a random convex combination
+// of their positions in a and b, ties kept in the order of a. Nodes near each
+// other in both parents stay near each other in the child.
+template<typename Z, typename Engine>
+std::vector<Z> crossover(const std::vector<Z> & a, const std::vector<Z> & b, Engine & engine) {
+    const Z n = a.size();
+
+    std::vector<double> key(n);
+
+    const double alpha = std::uniform_real_distribution<double>(.25, .75)(engine);
+
+    for (Z i = 0; i < n; i++) {
+        key[a[i]] += alpha * i; key[b[i]] += (1 - alpha) * i;
+    }
+
+    std::vector<Z> child = a;
+
+    std::stable_sort(child.begin(), child.end(), [&key] (const Z u, const Z v) { return key[u] < key[v]; });
+
+    return child;
+}
+
+// Kick for a search stuck at the incumbent: reverses strength random segments
+// of at most 16 positions.
+template<typename Z, typename Engine>
+std::vector<Z> perturb(std::vector<Z> sequence, const Z strength, Engine & engine) {
+    const Z n = sequence.size();
+
+    if (n < 2) {
+        return sequence;
+    }
+
+    std::uniform_int_distribution<Z> any(0, n - 2), length(2, 16);
+
+    for (Z k = 0; k < strength; k++) {
+        const Z i = any(engine);
+
+        std::reverse(sequence.begin() + i, sequence.begin() + std::min(n, i + length(engine)));
+    }
+
+    return sequence;
+}
+
+// Tabu Or-opt, annealing, window DP and successive augmentation, each
+// followed by Or-opt descent, with work proportional to the number of nodes.
+// The Or-opt and annealing moves and the augmentation stop early once budget
+// is exhausted.
+template<typename R, typename Z, typename W = Stored_Weights, typename O = Z>
+std::vector<Strategy<R, Z, W, O>> default_strategies() {
+    constexpr unsigned long long descent = 1000000;
+
+    return {
+        [] (const Graph<R, Z, W, O> & G, const std::vector<Z> & start, unsigned long long, const Budget & budget) {
+            return or_opt(G, start, Z(16), Z(8), 20ULL * numnodes(G), budget);
+        },
+        [] (const Graph<R, Z, W, O> & G, const std::vector<Z> & start, unsigned long long seed, const Budget & budget) {
+            Schedule<R> schedule;
+
+            schedule.moves = 100ULL * numnodes(G); schedule.seed = seed;
+
+            return or_opt(G, simulated_annealing(G, start, schedule, budget), Z(16), Z(0), descent, budget);
+        },
+        [] (const Graph<R, Z, W, O> & G, const std::vector<Z> & start, unsigned long long, const Budget & budget) {
+            return or_opt(G, window_dp(G, start, 8, Z(2)), Z(16), Z(0), descent, budget);
+        },
+        [] (const Graph<R, Z, W, O> & G, const std::vector<Z> & start, unsigned long long, const Budget & budget) {
+            return or_opt(G, successive_augmentation(G, start, budget), Z(16), Z(0), descent, budget);
+        }
+    };
+}
+
+// Runs strategies concurrently, one per thread (strategies are reused round
+// robin when there are more threads), around a shared Incumbent. Every worker
+// runs rounds: the first starts from sequence, later ones from the incumbent
+// when the worker's own best is worse (half of the time as is, half crossed
+// over with its own best) and from a perturbed copy of its own best when it
+// holds the incumbent. Each result is offered to the incumbent. Workers stop
+// after rounds rounds, once budget is exhausted or once the incumbent is
+// within its target gap, which is checked between rounds (the evaluation
+// limit is not used); the strategies get the time left and the token, so a
+// long round ends with the budget too. With a checkpoint in budget the search resumes from it
+// and the incumbent is written there at the end.
+// Nested OpenMP regions of the strategies run on their worker's thread. The
+// result depends on timing, as workers read the incumbent while it changes.
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> portfolio(const Graph<R, Z, W, O> & G, const std::vector<Z> & sequence,
+                         const std::vector<Strategy<R, Z, W, O>> & strategies = default_strategies<R, Z, W, O>(),
+                         const Budget & budget = Budget{}, const Z rounds = 8, const unsigned long long seed = 2019) {
+    const Z n = numnodes(G);
+
+    const std::vector<Z> start = resume_sequence<R, Z>(budget.checkpoint, sequence);
+
+    if (n < 2 || strategies.empty()) {
+        return start;
+    }
+
+    Stopwatch clock;
+
+    Incumbent<R, Z> incumbent(la(Arrangement<R, Z, W, O>(G, start)), start);
+
+    const Z workers = omp_get_max_threads();
+
+#   pragma omp parallel num_threads(workers)
+    {
+        const Z w = omp_get_thread_num();
+
+        const Strategy<R, Z, W, O> & strategy = strategies[w % strategies.size()];
+
+        std::mt19937_64 engine(seed + w);
+
+        std::vector<Z> own = start, from = start;
+
+        R own_cost = incumbent.best().cost;
+
+        for (Z round = 0; round < rounds && !budget.exhausted(clock, 0) && !budget.reached(incumbent.best().cost); round++) {
+            if (round > 0) {
+                const auto & best = incumbent.best();
+
+                if (best.cost < own_cost) {
+                    from = engine() % 2 ? best.sequence : crossover(own, best.sequence, engine);
+                }
+                else {
+                    from = perturb(own, std::max(Z(1), n / 64), engine);
+                }
+            }
+
+            std::vector<Z> result = strategy(G, from, seed + static_cast<unsigned long long>(round) * workers + w, budget.remaining(clock));
+
+            const R cost = la(Arrangement<R, Z, W, O>(G, result));
+
+            if (cost < own_cost) {
+                own_cost = cost; own = std::move(result);
+            }
+
+            incumbent.offer(own_cost, own);
+        }
+    }
+
+    const auto & best = incumbent.best();
+
+    if (!budget.checkpoint.empty()) {
+        write_checkpoint(budget.checkpoint, best.cost, best.sequence);
+    }
+
+    return best.sequence;
+}
+
+}
+
+#endif
@@ -0,0 +1,341 @@
+// "spectral_sequence.hh" -- implements template function spectral_sequence as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef SPECTRAL_SEQUENCE_HH
+#define SPECTRAL_SEQUENCE_HH
+
+#include "Graph.hh"
+#include <random>
+
+namespace lat {
+
+// y = L x for the Laplacian L = D - S of the undirected adjacency S.
+template<typename R, typename Z, typename W, typename O>
+void laplacian_product(const Graph<R, Z, W, O> & S, const std::vector<R> & D, const std::vector<R> & x, std::vector<R> & y) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z n = numnodes(S);
+
+#   pragma omp parallel for schedule(guided)
+    for (Z j = 0; j < n; j++) {
+        R sum = D[j] * x[j];
+
+        for (O i = JA[j]; i < JA[j + 1]; i++) {
+            sum -= A[i] * x[IA[i]];
+        }
+
+        y[j] = sum;
+    }
+}
+
+template<typename R>
+R dot(const std::vector<R> & x, const std::vector<R> & y) {
+    const std::ptrdiff_t n = x.size();
+
+    R sum = .0;
+
+#   pragma omp parallel for reduction(+ : sum)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        sum += x[i] * y[i];
+    }
+
+    return sum;
+}
+
+// Removes the component along the constant vector, the null space of L.
+template<typename R>
+void deflate(std::vector<R> & x) {
+    const std::ptrdiff_t n = x.size();
+
+    R sum = .0;
+
+#   pragma omp parallel for reduction(+ : sum)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        sum += x[i];
+    }
+
+    const R mean = sum / n;
+
+#   pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        x[i] -= mean;
+    }
+}
+
+// Eigenvector of the smallest eigenvalue of the k x k symmetric matrix H
+// (k <= 3), by cyclic Jacobi rotations.
+template<typename R>
+const std::vector<R> smallest_eigenvector(std::vector<std::vector<R>> H) {
+    const std::size_t k = H.size();
+
+    std::vector<std::vector<R>> V(k, std::vector<R>(k, .0));
+
+    for (std::size_t i = 0; i < k; i++) {
+        V[i][i] = 1.;
+    }
+
+    for (int sweep = 0; sweep < 50; sweep++) {
+        R off = .0;
+
+        for (std::size_t p = 0; p < k; p++) {
+            for (std::size_t q = p + 1; q < k; q++) {
+                off += H[p][q] * H[p][q];
+            }
+        }
+
+        if (off < 1e-30) {
+            break;
+        }
+
+        for (std::size_t p = 0; p < k; p++) {
+            for (std::size_t q = p + 1; q < k; q++) {
+                if (H[p][q] == 0) {
+                    continue;
+                }
+
+                const R theta = (H[q][q] - H[p][p]) / (2 * H[p][q]);
+
+                const R t = (theta >= 0 ? 1. : - 1.) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+
+                const R c = 1 / std::sqrt(t * t + 1), s = t * c;
+
+                for (std::size_t r = 0; r < k; r++) {
+                    const R hp = H[r][p], hq = H[r][q];
+
+                    H[r][p] = c * hp - s * hq; H[r][q] = s * hp + c * hq;
+                }
+
+                for (std::size_t r = 0; r < k; r++) {
+                    const R hp = H[p][r], hq = H[q][r];
+
+                    H[p][r] = c * hp - s * hq; H[q][r] = s * hp + c * hq;
+                }
+
+                for (std::size_t r = 0; r < k; r++) {
+                    const R vp = V[r][p], vq = V[r][q];
+
+                    V[r][p] = c * vp - s * vq; V[r][q] = s * vp + c * vq;
+                }
+            }
+        }
+    }
+
+    std::size_t m = 0;
+
+    for (std::size_t i = 1; i < k; i++) {
+        if (H[i][i] < H[m][m]) {
+            m = i;
+        }
+    }
+
+    std::vector<R> v(k);
+
+    for (std::size_t i = 0; i < k; i++) {
+        v[i] = V[i][m];
+    }
+
+    return v;
+}
+
+// Fiedler vector of the Laplacian of S = symmetrize(G), by single-vector
+// LOBPCG with a Jacobi (degree) preconditioner. Every iteration costs three
+// parallel sparse products, O(nnz). On return lambda holds the Rayleigh
+// quotient, an approximation of the algebraic connectivity lambda_2, and
+// converged, if given, whether the residual met tolerance within
+// max_iterations.
+template<typename R, typename Z, typename W, typename O>
+const std::vector<R> fiedler_vector(const Graph<R, Z, W, O> & S, R & lambda,
+                                    const Z max_iterations = 500, const R tolerance = 1e-6, const unsigned seed = 2019,
+                                    bool * converged = nullptr) {
+    const Z n = numnodes(S);
+
+    const auto & A = values(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    std::vector<R> D(n, .0);
+
+    R max_degree = .0;
+
+#   pragma omp parallel for reduction(max : max_degree)
+    for (Z j = 0; j < n; j++) {
+        for (O i = JA[j]; i < JA[j + 1]; i++) {
+            D[j] += A[i];
+        }
+
+        max_degree = std::max(max_degree, D[j]);
+    }
+
+    std::vector<R> x(n);
+
+    std::mt19937 engine(seed);
+
+    std::uniform_real_distribution<R> uniform(- 1., 1.);
+
+    for (auto & xi : x) {
+        xi = uniform(engine);
+    }
+
+    lambda = .0;
+
+    if (converged) {
+        *converged = n < 2;
+    }
+
+    if (n < 2) {
+        return x;
+    }
+
+    deflate(x);
+
+    std::vector<std::vector<R>> V, LV;
+
+    std::vector<R> p, Lx(n), r(n);
+
+    const auto normalize = [] (std::vector<R> & v) {
+        const R norm = std::sqrt(dot(v, v));
+
+        if (norm > 0) {
+            std::transform(v.begin(), v.end(), v.begin(), [norm] (R vi) { return vi / norm; });
+        }
+
+        return norm;
+    };
+
+    normalize(x);
+
+    for (Z iteration = 0; iteration < max_iterations; iteration++) {
+        laplacian_product(S, D, x, Lx);
+
+        lambda = dot(x, Lx);
+
+#       pragma omp parallel for
+        for (Z i = 0; i < n; i++) {
+            r[i] = Lx[i] - lambda * x[i];
+        }
+
+        if (std::sqrt(dot(r, r)) <= tolerance * 2 * std::max(max_degree, R(1))) {
+            if (converged) {
+                *converged = true;
+            }
+
+            break;
+        }
+
+#       pragma omp parallel for
+        for (Z i = 0; i < n; i++) {
+            r[i] /= D[i] > 0 ? D[i] : 1.;
+        }
+
+        deflate(r);
+
+        V.assign(1, x);
+
+        for (std::vector<R> * w : {&r, &p}) {
+            if (w->empty()) {
+                continue;
+            }
+
+            std::vector<R> v = *w;
+
+            for (int pass = 0; pass < 2; pass++) {
+                for (const auto & u : V) {
+                    const R c = dot(u, v);
+
+#                   pragma omp parallel for
+                    for (Z i = 0; i < n; i++) {
+                        v[i] -= c * u[i];
+                    }
+                }
+            }
+
+            if (normalize(v) > 1e-10) {
+                V.push_back(std::move(v));
+            }
+        }
+
+        const std::size_t k = V.size();
+
+        LV.assign(k, std::vector<R>(n));
+
+        LV[0] = Lx;
+
+        for (std::size_t a = 1; a < k; a++) {
+            laplacian_product(S, D, V[a], LV[a]);
+        }
+
+        std::vector<std::vector<R>> H(k, std::vector<R>(k));
+
+        for (std::size_t a = 0; a < k; a++) {
+            for (std::size_t b = a; b < k; b++) {
+                H[a][b] = H[b][a] = dot(V[a], LV[b]);
+            }
+        }
+
+        const std::vector<R> c = smallest_eigenvector(H);
+
+        p.assign(n, .0);
+
+#       pragma omp parallel for
+        for (Z i = 0; i < n; i++) {
+            R pi = .0;
+
+            for (std::size_t a = 1; a < k; a++) {
+                pi += c[a] * V[a][i];
+            }
+
+            p[i] = pi; x[i] = c[0] * x[i] + pi;
+        }
+
+        deflate(x);
+
+        normalize(x);
+    }
+
+    return x;
+}
+
+// Orders the nodes of G by their entry in the Fiedler vector, a seed for
+// full_search, parallel_full_search or successive_augmentation. Ties keep
+// node order.
+template<typename R, typename Z, typename W, typename O>
+const std::vector<Z> spectral_sequence(const Graph<R, Z, W, O> & G, const Z max_iterations = 500, const R tolerance = 1e-6) {
+    R lambda;
+
+    const std::vector<R> x = fiedler_vector(symmetrize(G), lambda, max_iterations, tolerance);
+
+    std::vector<Z> sequence(numnodes(G));
+
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    std::stable_sort(sequence.begin(), sequence.end(), [&x] (const Z a, const Z b) {
+                                                          return x[a] < x[b];
+                                                      });
+
+    return sequence;
+}
+
+}
+
+#endif
@@ -22,91 +22,145 @@
 #define SUCCESSIVE_AUGMENTATION
 
 #include "Graph.hh"
+#include "Arrangement.hh"
+#include "budget.hh"
 
 namespace lat {
 
-template<typename R, typename Z>
-std::vector<Z> successive_augmentation(const Graph<R, Z> & G, const std::vector<Z> & initial_sequence) {
-    Z n = numnodes(G);
+// Inserts node v into the partial arrangement P at the position of least cost,
+// preferring the rightmost one on ties. cut[b] is the weight of the edges
+// between placed nodes that cross the boundary in front of position b; the
+// cost of every position follows from cut and running sums of v's edge
+// weights to placed neighbours in one pass, O(|P| + deg(v)).
+template<typename R, typename Z, typename V, typename O>
+void insert_best(const Graph<R, Z, V, O> & S, Arrangement<R, Z, V, O> & P, std::vector<R> & cut, const Z v) {
+    const auto & A = values(S);
 
-    std::vector<Z> sequence;
+    const Array<Z> & IA = row_indices(S);
 
-    sequence.reserve(n);
+    const Array<O> & JA = col_ptrs(S);
 
-    Z cend, mid1, mid2, pos;
+    const Z c = P.size();
 
-    R min_cost;
+    std::vector<R> W(c, .0);
 
-    if (n % 2) {
-       cend = 1;
+    for (O k = JA[v]; k < JA[v + 1]; k++) {
+        const Z q = P.position(IA[k]);
+
+        if (q > - 1) {
+            W[q] += A[k];
+        }
+    }
 
-       mid1 = mid2 = n / 2 + 1;
+    R f = .0, lw = .0, rw = .0;
 
-       sequence.push_back(initial_sequence[mid1]);
+    for (Z q = 0; q < c; q++) {
+        f += W[q] * (q + 1); rw += W[q];
     }
-    else {
-        cend = 2;
 
-        mid1 = n / 2 - 1;
+    R min_cost = f + cut[0];
 
-        mid2 = n / 2;
+    Z pos = 0;
 
-        sequence.push_back(initial_sequence[mid1]);
+    for (Z p = 1; p <= c; p++) {
+        rw -= W[p - 1];
 
-        sequence.push_back(initial_sequence[mid2]);
-    }
+        f += lw - rw;
 
-    for (Z i = 0; i < mid1; i++) {
-        cend++;
+        lw += W[p - 1];
 
-        //std::cout << cend << '\n';
+        const R cost = f + cut[p];
 
-        sequence.push_back(initial_sequence[mid1 - 1 - i]);
+        if (cost <= min_cost) {
+            min_cost = cost;
 
-        min_cost = la(G(sequence));
+            pos = p;
+        }
+    }
 
-        pos = cend;
+    P.push_back(v);
 
-        for (Z j = cend - 1; j > 0; j--) {
-            std::swap(sequence[j], sequence[j - 1]);
+    P.insert(c, pos);
 
-            R cost = la(G(sequence));
+    cut.insert(cut.begin() + pos, cut[pos]);
 
-            if (cost < min_cost) {
-                min_cost = cost;
+    std::vector<R> d(c + 3, .0);
 
-                pos = j;
-            }
+    for (Z q = 0; q < c; q++) {
+        if (q < pos) {
+            d[q + 1] += W[q]; d[pos + 1] -= W[q];
         }
+        else {
+            d[pos + 1] += W[q]; d[q + 2] -= W[q];
+        }
+    }
+
+    R running = .0;
+
+    for (Z b = 0; b <= c + 1; b++) {
+        running += d[b];
+
+        cut[b] += running;
+    }
+}
 
-        std::rotate(sequence.begin(), sequence.begin() + 1, sequence.begin() + pos);
+// Builds a sequence by insert_best of the nodes of initial_sequence from its
+// middle outwards, O(n^2) overall. Once the time of budget runs out or its
+// token is cancelled, which is checked every 256 insertions, the nodes not yet
+// inserted stay where they are at the two ends of initial_sequence.
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> successive_augmentation(const Graph<R, Z, W, O> & G, const std::vector<Z> & initial_sequence,
+                                       const Budget & budget = Budget{}) {
+    Stopwatch clock;
 
-        cend++;
+    Z n = numnodes(G);
 
-        //std::cout << cend << '\n';
+    const Graph<R, Z, W, O> S = symmetrize(G);
 
-        sequence.push_back(initial_sequence[mid2 + 1 + i]);
+    Arrangement<R, Z, W, O> P(G, std::vector<Z>{});
 
-        min_cost = la(G(sequence));
+    std::vector<R> cut(1, .0);
 
-        pos = cend;
+    Z mid1, mid2;
 
-        for (Z j = cend - 1; j > 0; j--) {
-            std::swap(sequence[j], sequence[j - 1]);
+    if (n % 2) {
+       mid1 = mid2 = n / 2;
 
-            R cost = la(G(sequence));
+       insert_best(S, P, cut, initial_sequence[mid1]);
+    }
+    else {
+        mid1 = n / 2 - 1;
+
+        mid2 = n / 2;
 
-            if (cost < min_cost) {
-                min_cost = cost;
+        insert_best(S, P, cut, initial_sequence[mid1]);
 
-                pos = j;
-            }
+        insert_best(S, P, cut, initial_sequence[mid2]);
+    }
+
+    Z i = 0;
+
+    for (; i < mid1; i++) {
+        if (i % 128 == 127 && budget.exhausted(clock, 0)) {
+            break;
         }
 
-        std::rotate(sequence.begin(), sequence.begin() + 1, sequence.begin() + pos);
+        insert_best(S, P, cut, initial_sequence[mid1 - 1 - i]);
+
+        insert_best(S, P, cut, initial_sequence[mid2 + 1 + i]);
+    }
+
+    if (i < mid1) {
+        std::vector<Z> sequence(initial_sequence.begin(), initial_sequence.begin() + (mid1 - i));
+
+        sequence.insert(sequence.end(), P.sequence().begin(), P.sequence().end());
+
+        sequence.insert(sequence.end(), initial_sequence.begin() + (mid2 + 1 + i), initial_sequence.end());
+
+        return sequence;
     }
 
-    return sequence;
+    return P.sequence();
 }
 
 }
@@ -0,0 +1,94 @@
+// "swap_delta.hh" -- implements template function swap_delta as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef SWAP_DELTA_HH
+#define SWAP_DELTA_HH
+
+#include "Graph.hh"
+#include <cstdlib>
+
+namespace lat {
+
+// Inverse of sequence: pos[sequence[i]] = i, and - 1 for nodes not in sequence.
+template<typename Z>
+const std::vector<Z> positions(const std::vector<Z> & sequence, const Z n) {
+    std::vector<Z> pos(n, - 1);
+
+    const Z m = sequence.size();
+
+    for (Z i = 0; i < m; i++) {
+        pos[sequence[i]] = i;
+    }
+
+    return pos;
+}
+
+template<typename Z>
+const std::vector<Z> positions(const std::vector<Z> & sequence) {
+    return positions(sequence, static_cast<Z>(sequence.size()));
+}
+
+// Change in la(G(sequence)) caused by exchanging node a at position i with node
+// b at position j, where S is symmetrize(G) and position(u) yields the position
+// of any other node u. Costs O(deg(a) + deg(b)).
+template<typename R, typename Z, typename W, typename O, typename Position>
+const R swap_delta(const Graph<R, Z, W, O> & S, const Z a, const Z b, const Z i, const Z j, Position position) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    R delta = .0;
+
+    for (O k = JA[a]; k < JA[a + 1]; k++) {
+        const Z u = IA[k];
+
+        if (u != b) {
+            const Z pu = position(u);
+
+            delta += A[k] * (std::abs(j - pu) - std::abs(i - pu));
+        }
+    }
+
+    for (O k = JA[b]; k < JA[b + 1]; k++) {
+        const Z u = IA[k];
+
+        if (u != a) {
+            const Z pu = position(u);
+
+            delta += A[k] * (std::abs(i - pu) - std::abs(j - pu));
+        }
+    }
+
+    return delta;
+}
+
+// Change in la(G(sequence)) caused by swapping positions i and j, where S is
+// symmetrize(G) and pos the inverse of sequence.
+template<typename R, typename Z, typename W, typename O>
+const R swap_delta(const Graph<R, Z, W, O> & S, const std::vector<Z> & sequence, const std::vector<Z> & pos,
+                   const Z i, const Z j) {
+    return swap_delta(S, sequence[i], sequence[j], i, j, [&pos] (const Z u) { return pos[u]; });
+}
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+// "telemetry.hh" -- implements search observers and the library log stream as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef TELEMETRY_HH
+#define TELEMETRY_HH
+
+#include <iostream>
+#include <iomanip>
+#include <omp.h>
+
+namespace lat {
+
+// Stream the loaders and writers report to, std::clog unless changed; set it
+// to nullptr to silence them. Errors always go to std::cerr.
+inline std::ostream *& log_stream() {
+    static std::ostream * stream = &std::clog;
+
+    return stream;
+}
+
+template<typename... T>
+void note(const T & ... items) {
+    if (std::ostream * stream = log_stream()) {
+        (*stream << ... << items);
+    }
+}
+
+// State of a search as seen by an observer. iteration counts the moves
+// applied, moves_evaluated the candidate moves scored so far, and seconds
+// the wall time since the search started.
+struct Progress final {
+    unsigned long long iteration = 0, moves_evaluated = 0;
+
+    double cost = .0, seconds = .0, moves_per_second = .0;
+};
+
+// Observer of the search drivers. Every hook is empty, so this default
+// compiles away entirely. Custom observers derive from it and hide the hooks
+// they need; the drivers call them on the static type, so nothing is virtual.
+//
+//     on_iteration   : before every step, and once more after the last one
+//     on_phase       : when a phase (e.g. "symmetrize", "search") ends
+//     on_thread_work : moves evaluated by every thread, once at the end
+//     on_finish      : with the final state
+struct Null_Observer {
+    void on_iteration(const Progress &) { ; }
+
+    void on_phase(const char *, const double) { ; }
+
+    void on_thread_work(const int, const unsigned long long) { ; }
+
+    void on_finish(const Progress &) { ; }
+};
+
+// Prints "iteration cost" per step, the output full_search used to write to std::cout.
+struct Text_Observer : Null_Observer {
+    std::ostream & out;
+
+    Text_Observer(std::ostream & _out = std::cout) : out{_out} { ; }
+
+    void on_iteration(const Progress & p) {
+        out << p.iteration << ' ' << p.cost << '\n';
+    }
+};
+
+// Writes every event as one JSON object per line.
+struct Json_Lines_Observer : Null_Observer {
+    std::ostream & out;
+
+    Json_Lines_Observer(std::ostream & _out) : out{_out} { ; }
+
+    void on_iteration(const Progress & p) {
+        write("iteration", p);
+    }
+
+    void on_phase(const char * name, const double seconds) {
+        out << "{\"event\":\"phase\",\"name\":\"" << name << "\",\"seconds\":" << std::setprecision(9) << seconds << "}\n";
+    }
+
+    void on_thread_work(const int thread, const unsigned long long moves) {
+        out << "{\"event\":\"thread_work\",\"thread\":" << thread << ",\"moves\":" << moves << "}\n";
+    }
+
+    void on_finish(const Progress & p) {
+        write("finish", p);
+
+        out.flush();
+    }
+
+private:
+    void write(const char * event, const Progress & p) {
+        out << "{\"event\":\"" << event << "\",\"iteration\":" << p.iteration << ",\"cost\":" << std::setprecision(17) << p.cost
+            << ",\"moves_evaluated\":" << p.moves_evaluated << ",\"seconds\":" << std::setprecision(9) << p.seconds
+            << ",\"moves_per_second\":" << p.moves_per_second << "}\n";
+    }
+};
+
+// Wall clock of a search, filling the timing fields of Progress.
+class Stopwatch final {
+public:
+    Stopwatch() : start{omp_get_wtime()}, lap{start} { ; }
+
+    // Seconds since construction.
+    double elapsed() const {
+        return omp_get_wtime() - start;
+    }
+
+    // Seconds since the previous call (or construction).
+    double split() {
+        const double now = omp_get_wtime(), t = now - lap;
+
+        lap = now;
+
+        return t;
+    }
+
+    void stamp(Progress & p) const {
+        p.seconds = omp_get_wtime() - start;
+
+        p.moves_per_second = p.seconds > 0 ? p.moves_evaluated / p.seconds : .0;
+    }
+
+private:
+    double start, lap;
+};
+
+}
+
+#endif
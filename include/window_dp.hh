@@ -0,0 +1,209 @@
+// "window_dp.hh" -- implements template function window_dp as part of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+
+#ifndef WINDOW_DP_HH
+#define WINDOW_DP_HH
+
+#include "Graph.hh"
+#include "swap_delta.hh"
+#include <cstdint>
+
+namespace lat {
+
+// Per-thread tables of the subset dynamic program, sized once for the largest
+// window and reused for every window the thread handles.
+template<typename R>
+struct Window_Arena final {
+    std::vector<R> best, cut, weight, slope;
+
+    std::vector<std::int8_t> last;
+
+    Window_Arena(const int k) :
+    best(std::size_t(1) << k), cut(std::size_t(1) << k), weight(k * k), slope(k), last(std::size_t(1) << k) { ; }
+};
+
+// Reorders positions [lo, lo + k) of sequence optimally. A node at offset t
+// pays t * (left - right) for its edges to nodes left and right of the
+// window, and internal edges cost the sum over the window's inner
+// boundaries of the weight crossing them, so
+//
+//     best(T) = min over v in T of best(T \ v) + (|T| - 1) * slope(v) + cut(T).
+//
+// Only which side of the window an outside node lies on matters, so windows
+// that do not overlap can be solved concurrently against the same pos.
+// Returns the cost reduction (0 if the current order is already optimal).
+template<typename R, typename Z, typename W, typename O>
+R solve_window(const Graph<R, Z, W, O> & S, std::vector<Z> & sequence, const std::vector<Z> & pos,
+               const Z lo, const int k, Window_Arena<R> & arena) {
+    const auto & A = values(S);
+
+    const Array<Z> & IA = row_indices(S);
+
+    const Array<O> & JA = col_ptrs(S);
+
+    const Z hi = lo + k;
+
+    std::fill(arena.weight.begin(), arena.weight.begin() + k * k, R(0));
+
+    for (int a = 0; a < k; a++) {
+        const Z v = sequence[lo + a];
+
+        R slope = .0;
+
+        for (O i = JA[v]; i < JA[v + 1]; i++) {
+            const Z q = pos[IA[i]];
+
+            if (q < lo) {
+                slope += A[i];
+            }
+            else if (q >= hi) {
+                slope -= A[i];
+            }
+            else {
+                arena.weight[a * k + (q - lo)] += A[i];
+            }
+        }
+
+        arena.slope[a] = slope;
+    }
+
+    const std::uint32_t full = (std::uint32_t(1) << k) - 1;
+
+    arena.best[0] = 0; arena.cut[0] = 0;
+
+    for (std::uint32_t T = 1; T <= full; T++) {
+        const int low = __builtin_ctz(T);
+
+        R degree = .0, inside = .0;
+
+        for (int b = 0; b < k; b++) {
+            degree += arena.weight[low * k + b];
+
+            if ((T >> b) & 1) {
+                inside += arena.weight[low * k + b];
+            }
+        }
+
+        arena.cut[T] = arena.cut[T & (T - 1)] + degree - 2 * inside;
+
+        const R t = __builtin_popcount(T) - 1;
+
+        R best = .0;
+
+        int last = - 1;
+
+        for (std::uint32_t rest = T; rest; rest &= rest - 1) {
+            const int v = __builtin_ctz(rest);
+
+            const R cost = arena.best[T ^ (std::uint32_t(1) << v)] + t * arena.slope[v];
+
+            if (last < 0 || cost < best) {
+                best = cost; last = v;
+            }
+        }
+
+        arena.best[T] = best + arena.cut[T]; arena.last[T] = last;
+    }
+
+    R current = .0;
+
+    for (std::uint32_t T = 0, a = 0; a < std::uint32_t(k); a++) {
+        T |= std::uint32_t(1) << a;
+
+        current += a * arena.slope[a] + arena.cut[T];
+    }
+
+    const R gain = current - arena.best[full];
+
+    if (!(gain > 0)) {
+        return 0;
+    }
+
+    Z order[32];
+
+    for (std::uint32_t T = full, t = k; T; t--) {
+        const int v = arena.last[T];
+
+        order[t - 1] = sequence[lo + v];
+
+        T ^= std::uint32_t(1) << v;
+    }
+
+    std::copy(order, order + k, sequence.begin() + lo);
+
+    return gain;
+}
+
+// Sliding-window refinement: every sweep solves the windows of k consecutive
+// positions starting at 0, k, 2k, ... and then at k / 2, 3k / 2, ... exactly,
+// the non-overlapping windows of each pass in parallel with the subset tables
+// kept in per-thread arenas. k is limited to 2 to 16; the work per window is
+// O(2^k * k). Stops after sweeps sweeps or once a sweep gains nothing.
+template<typename R, typename Z, typename W, typename O>
+std::vector<Z> window_dp(const Graph<R, Z, W, O> & G, std::vector<Z> sequence, int k = 10, const Z sweeps = 4) {
+    const Graph<R, Z, W, O> S = symmetrize(G);
+
+    const Z n = sequence.size();
+
+    k = std::max(2, std::min(k, 16));
+
+    if (n < k) {
+        k = n;
+    }
+
+    if (k < 2) {
+        return sequence;
+    }
+
+    std::vector<Z> pos = positions(sequence, numnodes(S));
+
+    for (Z sweep = 0; sweep < sweeps; sweep++) {
+        R gain = .0;
+
+        for (const Z offset : {Z(0), Z(k / 2)}) {
+            const Z windows = (n - offset) / k;
+
+#           pragma omp parallel reduction(+ : gain)
+            {
+                Window_Arena<R> arena(k);
+
+#               pragma omp for schedule(dynamic, 64)
+                for (Z w = 0; w < windows; w++) {
+                    gain += solve_window(S, sequence, pos, offset + w * k, k, arena);
+                }
+            }
+
+#           pragma omp parallel for
+            for (Z i = 0; i < n; i++) {
+                pos[sequence[i]] = i;
+            }
+        }
+
+        if (!(gain > 0)) {
+            break;
+        }
+    }
+
+    return sequence;
+}
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+// "batch.cc" -- batch solver of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Build : cmake --build build --target batch (see CMakeLists.txt), or
+//         g++ -std=c++17 -O3 -fopenmp -I../include batch.cc -o batch
+// Usage : ./batch input_directory output_directory [options]
+//
+//     --memory GB      bound on the estimated memory of the graphs in flight (default none)
+//     --workers N      graphs solved at once (default one per thread)
+//     --solver NAME    augmentation (default), or_opt, anytime or portfolio
+//     --seconds S      time budget per graph of anytime and portfolio
+//     --manifest FILE  JSON line per graph (default output_directory/manifest.jsonl)
+//     --verbose        log every load and write to std::clog
+//
+// Every input_directory/<name>.mtx is solved from the identity and its
+// sequence written to output_directory/<name>.seq in the write_mtx_sequence
+// format. portfolio runs all threads on each graph, so use it with --workers 1.
+// A graph that cannot be loaded is recorded in the manifest with its error and
+// the others are still solved; the exit status is then non-zero.
+
+#include "batch.hh"
+#include "anytime_search.hh"
+#include "or_opt.hh"
+#include "portfolio.hh"
+#include "successive_augmentation.hh"
+#include <cstring>
+
+using Z = int;
+
+using R = double;
+
+int main(int argc, char * argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage : " << argv[0] << " input_directory output_directory [--memory GB] [--workers N]"
+                  << " [--solver augmentation|or_opt|anytime|portfolio] [--seconds S] [--manifest FILE] [--verbose]\n";
+
+        return EXIT_FAILURE;
+    }
+
+    lat::Batch_Options options;
+
+    options.manifest = (std::filesystem::path(argv[2]) / "manifest.jsonl").string();
+
+    std::string solver = "augmentation";
+
+    lat::Budget budget;
+
+    lat::log_stream() = nullptr;
+
+    for (int k = 3; k < argc; k++) {
+        const bool has_value = k + 1 < argc;
+
+        if (!std::strcmp(argv[k], "--memory") && has_value) {
+            options.memory_budget = std::stod(argv[++k]) * (1ULL << 30);
+        }
+        else if (!std::strcmp(argv[k], "--workers") && has_value) {
+            options.workers = std::stoi(argv[++k]);
+        }
+        else if (!std::strcmp(argv[k], "--solver") && has_value) {
+            solver = argv[++k];
+        }
+        else if (!std::strcmp(argv[k], "--seconds") && has_value) {
+            budget.seconds = std::stod(argv[++k]);
+        }
+        else if (!std::strcmp(argv[k], "--manifest") && has_value) {
+            options.manifest = argv[++k];
+        }
+        else if (!std::strcmp(argv[k], "--verbose")) {
+            lat::log_stream() = &std::clog;
+        }
+        else {
+            std::cerr << "unknown option : " << argv[k] << '\n';
+
+            return EXIT_FAILURE;
+        }
+    }
+
+    const std::vector<lat::Batch_Job> jobs = lat::batch_jobs<R, Z>(argv[1], argv[2]);
+
+    const double start = omp_get_wtime();
+
+    std::vector<lat::Batch_Result> results;
+
+    if (solver == "augmentation") {
+        results = lat::solve_batch<R, Z>(jobs, [] (const lat::Graph<R, Z> & G, const std::vector<Z> & s) {
+                                                   return lat::or_opt(G, lat::successive_augmentation(G, s));
+                                               }, options);
+    }
+    else if (solver == "or_opt") {
+        results = lat::solve_batch<R, Z>(jobs, [] (const lat::Graph<R, Z> & G, const std::vector<Z> & s) {
+                                                   return lat::or_opt(G, s, Z(16), Z(8), 20ULL * lat::numnodes(G));
+                                               }, options);
+    }
+    else if (solver == "anytime") {
+        results = lat::solve_batch<R, Z>(jobs, [&budget] (const lat::Graph<R, Z> & G, const std::vector<Z> & s) {
+                                                          return lat::anytime_search(G, lat::successive_augmentation(G, s), budget);
+                                                      }, options);
+    }
+    else if (solver == "portfolio") {
+        results = lat::solve_batch<R, Z>(jobs, [&budget] (const lat::Graph<R, Z> & G, const std::vector<Z> & s) {
+                                                          return lat::portfolio(G, s, lat::default_strategies<R, Z>(), budget);
+                                                      }, options);
+    }
+    else {
+        std::cerr << "unknown solver : " << solver << '\n';
+
+        return EXIT_FAILURE;
+    }
+
+    double initial = .0, final = .0;
+
+    std::size_t failed = 0;
+
+    for (const lat::Batch_Result & r : results) {
+        initial += r.initial_cost; final += r.cost;
+
+        if (!r.error.empty()) {
+            std::cerr << r.error << '\n';
+
+            failed++;
+        }
+    }
+
+    std::cout << results.size() << " graphs (" << failed << " failed) in " << omp_get_wtime() - start << " s, total cost "
+              << initial << " -> " << final << ", manifest " << options.manifest << '\n';
+
+    return failed > 0 ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,63 @@
+// "exact.cc" -- exact solver of the L(inear) A(rrangement) T(oolbox) library.
+//
+// Copyright (C) 2019 Georgios N Printezis
+//
+// This file is part of the LAT library. This library is free
+// software; you can distribute it and/or modify it under the
+// the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+// Contact me on johakepl@gmail.com.
+//
+// Build : cmake --build build --target exact (see CMakeLists.txt), or
+//         g++ -std=c++17 -O3 -fopenmp -I../include exact.cc -o exact
+// Usage : ./exact graph.mtx output.seq [seconds = 0]
+//
+// Solves graph.mtx (at most 64 nodes) with branch_and_bound and writes the
+// sequence with write_mtx_sequence, so the cost in its header is the proven
+// optimum. If the time limit stops the search first the best sequence found
+// is written all the same and the exit status is 2.
+
+#include "branch_and_bound.hh"
+#include "load_mtx.hh"
+
+using Z = int;
+
+using R = double;
+
+int main(int argc, char * argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage : " << argv[0] << " graph.mtx output.seq [seconds]\n";
+
+        return EXIT_FAILURE;
+    }
+
+    const lat::Graph<R, Z> G = lat::load_mtx<R, Z>(argv[1]);
+
+    lat::Budget budget;
+
+    budget.seconds = argc > 3 ? std::stod(argv[3]) : 0;
+
+    R cost;
+
+    bool optimal;
+
+    const double start = omp_get_wtime();
+
+    const std::vector<Z> sequence = lat::branch_and_bound(G, cost, optimal, budget);
+
+    lat::write_mtx_sequence(argv[2], cost, sequence);
+
+    std::cout << (optimal ? "optimal" : "best found") << " cost " << std::fixed << cost << " in " << omp_get_wtime() - start << " s\n";
+
+    return optimal ? 0 : 2;
+}